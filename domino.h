@@ -0,0 +1,375 @@
+/**
+ * @file domino.h
+ * @author FafNir
+ * @brief Interfaccia pubblica della libreria libdomino: risolve mani di Domino lineare attraverso un contesto
+ * DominoSolver. Ogni contesto possiede la propria memoria, tabella delle trasposizioni e generatore casuale, quindi
+ * contesti diversi possono essere usati contemporaneamente da thread diversi. Un singolo contesto non va usato da più
+ * thread alla volta. La libreria non scrive su stdout e non termina il processo: ogni errore, compresa la mancanza di
+ * memoria, viene restituito con un codice DOMINO_ERR_*
+ */
+
+#ifndef DOMINO_H
+#define DOMINO_H
+
+#include<stdio.h>
+#include<stddef.h>
+#include<stdint.h>
+#include<stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// @brief Simboli esportati dalla libreria condivisa, compilata con -fvisibility=hidden
+#if defined(__GNUC__)
+#define DOMINO_API __attribute__((visibility("default")))
+#else
+#define DOMINO_API
+#endif
+
+/// @brief Motore di ricerca esatto sull'albero delle mosse
+#define DOMINO_ENGINE_SEARCH 0
+/// @brief Motore esatto che risolve le posizioni senza tessere speciali come scie del multigrafo dei valori
+#define DOMINO_ENGINE_GRAPH 1
+/// @brief Motore euristico a fascio, per le mani troppo grandi per la ricerca esatta
+#define DOMINO_ENGINE_BEAM 2
+
+/// @brief Mano estratta senza tessere speciali
+#define DOMINO_MIX_PLAIN 0
+/// @brief Mano estratta con tutti i tipi di tessera equiprobabili
+#define DOMINO_MIX_UNIFORM 1
+/// @brief Mano estratta con un terzo di tessere speciali
+#define DOMINO_MIX_SPECIAL 2
+
+/// @brief Numero massimo di tessere in mano coperte da una tablebase
+#define DOMINO_TABLEBASE_MAX_TILES 6
+
+/// @brief Operazione riuscita
+#define DOMINO_OK 0
+/// @brief La mano contiene una tessera che non esiste o troppe copie di una tessera
+#define DOMINO_ERR_INVALID_HAND -1
+/// @brief Le opzioni o gli argomenti non sono validi
+#define DOMINO_ERR_INVALID_ARGUMENT -2
+/// @brief Memoria insufficiente per il risultato
+#define DOMINO_ERR_NO_MEMORY -3
+/// @brief Un file non può essere aperto, letto o scritto
+#define DOMINO_ERR_IO -4
+/// @brief Il file non è una cache o una tablebase, oppure è troncato
+#define DOMINO_ERR_BAD_FILE -5
+/// @brief La mossa non è valida nella posizione attuale della partita
+#define DOMINO_ERR_ILLEGAL_MOVE -6
+
+/**
+ * @struct DominoSolver
+ * @brief Contesto del risolutore, opaco per chi usa la libreria
+*/
+typedef struct DominoSolver DominoSolver;
+
+/**
+ * @struct DominoCache
+ * @brief Cache persistente dei risultati ottimi, opaca. Può essere condivisa da più contesti e da più thread
+*/
+typedef struct DominoCache DominoCache;
+
+/**
+ * @struct DominoTablebase
+ * @brief Tablebase delle posizioni con poche tessere in mano, opaca. Viene solo letta, quindi può essere condivisa da
+ * più contesti e da più thread
+*/
+typedef struct DominoTablebase DominoTablebase;
+
+/**
+ * @struct DominoGame
+ * @brief Partita giocata mossa per mossa, opaca, con i suggerimenti calcolati in background
+*/
+typedef struct DominoGame DominoGame;
+
+/**
+ * @struct DominoStats
+ * @brief Contatori di una ricerca, opachi, presenti solo se la libreria è compilata con -DDOMINO_STATS
+*/
+typedef struct DominoStats DominoStats;
+
+/**
+ * @struct DominoOptions
+ * @brief Definisce il tipo DominoOptions: le opzioni con cui viene creato un DominoSolver
+*/
+typedef struct {
+  /** Motore (DOMINO_ENGINE_SEARCH, DOMINO_ENGINE_GRAPH o DOMINO_ENGINE_BEAM) */
+  int engine;
+  /** Numero di thread usati da ogni ricerca */
+  int threads;
+  /** Dimensione in MB della tabella delle trasposizioni del contesto (0 per non usarla) */
+  size_t tt_mb;
+  /** Tempo massimo di ogni ricerca in millisecondi (0 per nessun limite) */
+  long time_ms;
+  /** Numero massimo di posizioni espanse da ogni ricerca (0 per nessun limite) */
+  uint64_t max_nodes;
+  /** Numero di posizioni tenute ad ogni mossa dal motore a fascio */
+  int beam_width;
+  /** true se il motore a fascio deve calcolare anche l'ottimo con la ricerca esatta, per misurarne lo scarto */
+  bool beam_exact;
+  /** Cache in cui cercare e salvare i risultati ottimi (NULL per non usarla) */
+  DominoCache* cache;
+  /** Tablebase da consultare durante la ricerca (NULL per non usarla) */
+  DominoTablebase const* tablebase;
+  /** File su cui viene mostrato l'avanzamento delle ricerche (NULL per non mostrarlo) */
+  FILE* progress;
+  /** File su cui vengono scritte le istantanee periodiche dei contatori (NULL per non scriverle) */
+  FILE* stats;
+  /** Intervallo tra due istantanee dei contatori in millisecondi */
+  long stats_interval;
+} DominoOptions;
+
+/**
+ * @struct DominoTile
+ * @brief Definisce il tipo DominoTile: una tessera, normale da [1|1] a [6|6] o speciale [0|0], [11|11] e [12|21]
+*/
+typedef struct {
+  /** Valore sinistro */
+  int left;
+  /** Valore destro */
+  int right;
+} DominoTile;
+
+/**
+ * @struct DominoMove
+ * @brief Definisce il tipo DominoMove: una mossa della partita trovata
+*/
+typedef struct {
+  /** Tessera giocata, nel verso in cui è stata inserita */
+  DominoTile tile;
+  /** Lato del campo ('S' per la prima tessera, poi 'L' o 'R') */
+  char side;
+  /** Valori che la tessera ha assunto nel campo subito dopo la mossa */
+  DominoTile placed;
+} DominoMove;
+
+/**
+ * @struct DominoResult
+ * @brief Definisce il tipo DominoResult: il risultato di una ricerca, da liberare con domino_result_free
+*/
+typedef struct {
+  /** Punteggio totale della partita trovata */
+  int total;
+  /** true se il punteggio è dimostrato ottimo */
+  bool proven;
+  /** Numero di posizioni espanse */
+  uint64_t nodes;
+  /** Numero di rami scartati */
+  uint64_t cutoffs;
+  /** Mosse della partita trovata */
+  DominoMove* moves;
+  /** Numero di mosse */
+  int n_moves;
+  /** Punteggio ottimo con cui confrontare quello del motore a fascio (-1 se non noto) */
+  int optimum;
+  /** true se il risultato è stato letto dalla cache */
+  bool cache_hit;
+  /** Contatori della ricerca (NULL se la libreria non è compilata con -DDOMINO_STATS) */
+  DominoStats* stats;
+} DominoResult;
+
+/**
+ * @brief Funzione che descrive un codice restituito dalla libreria
+ * @param status DOMINO_OK o un codice DOMINO_ERR_*
+ * @return Una descrizione in inglese, senza punto finale
+*/
+DOMINO_API char const* domino_strerror(int status);
+
+/**
+ * @brief Funzione che mescola i bit di un intero (finalizzatore di splitmix64), per ricavare semi indipendenti da
+ * valori vicini come un indice o un orologio
+ * @param x intero da mescolare
+ * @return L'intero mescolato
+*/
+DOMINO_API uint64_t domino_seed_mix(uint64_t x);
+
+/**
+ * @brief Funzione che scrive le opzioni predefinite, le stesse del programma senza argomenti
+ * @param options DominoOptions da inizializzare
+*/
+DOMINO_API void domino_options_default(DominoOptions* options);
+
+/**
+ * @brief Funzione che crea un contesto del risolutore
+ * @param options opzioni delle ricerche (NULL per quelle predefinite)
+ * @param seed seme del generatore casuale del contesto
+ * @param stream flusso del generatore: contesti con lo stesso seme e flussi diversi estraggono sequenze che non si
+ * sovrappongono, ad esempio uno per thread
+ * @param solver puntatore in cui viene scritto il nuovo contesto
+ * @return DOMINO_OK, DOMINO_ERR_INVALID_ARGUMENT se le opzioni non sono valide, o DOMINO_ERR_NO_MEMORY
+*/
+DOMINO_API int domino_solver_create(DominoOptions const* options, uint64_t seed, uint64_t stream, DominoSolver** solver);
+
+/**
+ * @brief Funzione che libera un contesto e tutta la sua memoria
+ * @param solver contesto da liberare (può essere NULL)
+*/
+DOMINO_API void domino_solver_free(DominoSolver* solver);
+
+/**
+ * @brief Funzione che estrae una mano casuale con il generatore del contesto, con tutti i tipi di tessera equiprobabili
+ * @param solver contesto
+ * @param tiles array di almeno n elementi in cui vengono scritte le tessere
+ * @param n numero di tessere
+ * @return DOMINO_OK, o DOMINO_ERR_INVALID_ARGUMENT se n è negativo
+*/
+DOMINO_API int domino_random_hand(DominoSolver* solver, DominoTile* tiles, int n);
+
+/**
+ * @brief Funzione che estrae una mano riproducibile: lo stesso seme dà sempre la stessa mano
+ * @param seed seme
+ * @param mix composizione della mano (DOMINO_MIX_PLAIN, DOMINO_MIX_UNIFORM o DOMINO_MIX_SPECIAL)
+ * @param tiles array di almeno n elementi in cui vengono scritte le tessere
+ * @param n numero di tessere
+ * @return DOMINO_OK, o DOMINO_ERR_INVALID_ARGUMENT se mix o n non sono validi
+*/
+DOMINO_API int domino_seeded_hand(uint64_t seed, int mix, DominoTile* tiles, int n);
+
+/**
+ * @brief Funzione che cerca la partita migliore per una mano, partendo dal campo vuoto
+ * @param solver contesto
+ * @param tiles tessere della mano
+ * @param n numero di tessere
+ * @param result DominoResult in cui viene scritto il risultato, valido solo se la funzione restituisce DOMINO_OK
+ * @return DOMINO_OK, DOMINO_ERR_INVALID_HAND, DOMINO_ERR_INVALID_ARGUMENT o DOMINO_ERR_NO_MEMORY
+*/
+DOMINO_API int domino_solve(DominoSolver* solver, DominoTile const* tiles, int n, DominoResult* result);
+
+/**
+ * @brief Funzione che libera le mosse e i contatori di un DominoResult
+ * @param result risultato da liberare
+*/
+DOMINO_API void domino_result_free(DominoResult* result);
+
+/**
+ * @brief Funzione che scrive i contatori della ricerca di un risultato
+ * @param result risultato
+ * @param out file su cui scriverli
+ * @return DOMINO_OK, o DOMINO_ERR_INVALID_ARGUMENT se il risultato non ha contatori
+*/
+DOMINO_API int domino_result_print_stats(DominoResult const* result, FILE* out);
+
+/**
+ * @brief Funzione che apre la cache persistente dei risultati, creando il file se non esiste. Più processi possono
+ * usare lo stesso file: le scritture sono protette da un lock sul file path.lock
+ * @param path percorso del file
+ * @param max_mb dimensione massima del file in MB: quando viene superata il file è riscritto con i record più usati
+ * @param cache puntatore in cui viene scritta la cache aperta
+ * @return DOMINO_OK, DOMINO_ERR_INVALID_ARGUMENT, DOMINO_ERR_IO, DOMINO_ERR_BAD_FILE o DOMINO_ERR_NO_MEMORY
+*/
+DOMINO_API int domino_cache_open(char const* path, size_t max_mb, DominoCache** cache);
+
+/**
+ * @brief Funzione che chiude una cache, dopo che tutti i contesti che la usano hanno terminato le ricerche
+ * @param cache cache da chiudere (può essere NULL)
+*/
+DOMINO_API void domino_cache_close(DominoCache* cache);
+
+/**
+ * @brief Funzione che carica una tablebase generata con domino_tablebase_generate, mappandola in memoria
+ * @param path percorso del file
+ * @param tablebase puntatore in cui viene scritta la tablebase caricata
+ * @return DOMINO_OK, DOMINO_ERR_INVALID_ARGUMENT, DOMINO_ERR_IO, DOMINO_ERR_BAD_FILE o DOMINO_ERR_NO_MEMORY
+*/
+DOMINO_API int domino_tablebase_load(char const* path, DominoTablebase** tablebase);
+
+/**
+ * @brief Funzione che libera una tablebase, dopo che tutti i contesti che la usano hanno terminato le ricerche
+ * @param tablebase tablebase da liberare (può essere NULL)
+*/
+DOMINO_API void domino_tablebase_free(DominoTablebase* tablebase);
+
+/**
+ * @brief Funzione che genera la tablebase di tutte le mani fino a tiles tessere e la scrive su file
+ * @param path percorso del file
+ * @param tiles numero massimo di tessere in mano, al più DOMINO_TABLEBASE_MAX_TILES
+ * @param threads numero di thread
+ * @param log file su cui viene scritto il tempo di ogni livello (NULL per non scriverlo)
+ * @return DOMINO_OK, DOMINO_ERR_INVALID_ARGUMENT, DOMINO_ERR_IO o DOMINO_ERR_NO_MEMORY
+*/
+DOMINO_API int domino_tablebase_generate(char const* path, int tiles, int threads, FILE* log);
+
+/**
+ * @brief Funzione che inizia una partita dal campo vuoto. La partita usa le opzioni del contesto per i suggerimenti,
+ * ma non il contesto stesso, che può essere liberato prima
+ * @param solver contesto
+ * @param tiles tessere della mano
+ * @param n numero di tessere
+ * @param game puntatore in cui viene scritta la nuova partita
+ * @return DOMINO_OK, DOMINO_ERR_INVALID_HAND, DOMINO_ERR_INVALID_ARGUMENT o DOMINO_ERR_NO_MEMORY
+*/
+DOMINO_API int domino_game_create(DominoSolver const* solver, DominoTile const* tiles, int n, DominoGame** game);
+
+/**
+ * @brief Funzione che libera una partita, fermando i suggerimenti
+ * @param game partita da liberare (può essere NULL)
+*/
+DOMINO_API void domino_game_free(DominoGame* game);
+
+/**
+ * @brief Funzione che gioca una tessera della mano
+ * @param game partita
+ * @param side lato del campo ('S' per la prima tessera, poi 'L' o 'R')
+ * @param tile tessera, in uno qualsiasi dei due versi
+ * @return DOMINO_OK, o DOMINO_ERR_ILLEGAL_MOVE se la tessera non è in mano o non può essere giocata su quel lato
+*/
+DOMINO_API int domino_game_play(DominoGame* game, char side, DominoTile tile);
+
+/**
+ * @brief Funzione che controlla se la partita può continuare
+ * @param game partita
+ * @return true se almeno una tessera della mano può essere giocata
+*/
+DOMINO_API bool domino_game_can_move(DominoGame const* game);
+
+/**
+ * @brief Funzione che calcola il punteggio attuale della partita
+ * @param game partita
+ * @return La somma dei valori delle tessere nel campo
+*/
+DOMINO_API int domino_game_points(DominoGame const* game);
+
+/**
+ * @brief Funzione che legge il campo, da sinistra a destra
+ * @param game partita
+ * @param tiles array in cui vengono scritte al più max tessere
+ * @param max dimensione dell'array
+ * @return Il numero di tessere nel campo
+*/
+DOMINO_API int domino_game_field(DominoGame const* game, DominoTile* tiles, int max);
+
+/**
+ * @brief Funzione che legge la mano, ordinata per tipo di tessera
+ * @param game partita
+ * @param tiles array in cui vengono scritte al più max tessere
+ * @param max dimensione dell'array
+ * @return Il numero di tessere in mano
+*/
+DOMINO_API int domino_game_hand(DominoGame const* game, DominoTile* tiles, int max);
+
+/**
+ * @brief Funzione che avvia i suggerimenti: un thread analizza la posizione mentre il giocatore pensa, e ricomincia
+ * dopo ogni mossa giocata con domino_game_play
+ * @param game partita
+ * @return DOMINO_OK, DOMINO_ERR_INVALID_ARGUMENT se sono già attivi, o DOMINO_ERR_NO_MEMORY
+*/
+DOMINO_API int domino_game_start_hints(DominoGame* game);
+
+/**
+ * @brief Funzione che legge il suggerimento attuale
+ * @param game partita
+ * @param side carattere in cui viene scritto il lato della mossa suggerita
+ * @param tile DominoTile in cui viene scritta la tessera suggerita, nel verso in cui va giocata
+ * @param total intero in cui viene scritto il punteggio totale della partita che segue il suggerimento
+ * @param proven bool in cui viene scritto true se quel punteggio è dimostrato ottimo
+ * @return true se c'è un suggerimento, false se l'analisi non ha ancora trovato una partita o i suggerimenti non sono attivi
+*/
+DOMINO_API bool domino_game_hint(DominoGame* game, char* side, DominoTile* tile, int* total, bool* proven);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1863 @@
+/**
+ * @file engine.h
+ * @author FafNir
+ * @brief Tipi e prototipi interni del motore della libreria libdomino, incluso solo da solver.c.
+ * Chi usa la libreria include "domino.h"
+ * @date 26/01/2024
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stddef.h>
+#include<string.h>
+#include<time.h>
+#include<stdbool.h>
+#include<stdint.h>
+#include<stdatomic.h>
+#include<pthread.h>
+#include<limits.h>
+#include<assert.h>
+#include<errno.h>
+#include<unistd.h>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include<immintrin.h>
+#endif
+#include "domino.h"
+
+/// @brief Numero di tipi di tessera distinti: 36 tessere normali più [11|11], [0|0] e [12|21]
+#define TILE_KINDS 39
+/// @brief Tipo della tessera speciale [11|11]
+#define SUM_KIND 36
+/// @brief Tipo della tessera speciale [0|0]
+#define ANY_KIND 37
+/// @brief Tipo della tessera speciale [12|21]
+#define MIRROR_KIND 38
+/// @brief Memoria di default (in MB) della tabella delle trasposizioni usata dalla modalità AI
+#define TT_DEFAULT_MB 64
+/// @brief Numero massimo di mosse possibili da una posizione: ogni tipo di tessera su due lati e in due versi
+#define MAX_MOVES (TILE_KINDS*4)
+/// @brief Numero massimo di mosse dalla radice dopo cui la ricerca parallela smette di dividere i rami in sotto-attività
+#define SPLIT_DEPTH 3
+/// @brief Numero di posizioni espanse tra un controllo e l'altro del budget della ricerca
+#define BUDGET_CHECK 1024
+/// @brief Numero di mani prese insieme da ogni thread della generazione della tablebase
+#define TABLEBASE_CHUNK 64
+/// @brief Numero di profondità distinte nelle statistiche: le posizioni più profonde sono contate nell'ultima
+#define STATS_DEPTHS 128
+/// @brief Intervallo predefinito in millisecondi tra due istantanee delle statistiche
+#define STATS_DEFAULT_INTERVAL 1000
+
+//Le statistiche della ricerca vengono compilate solo con -DDOMINO_STATS: senza, STAT non genera codice
+#ifdef DOMINO_STATS
+#define STAT(...) do { __VA_ARGS__; } while(0)
+#else
+#define STAT(...) do { } while(0)
+#endif
+
+/// @brief Motore della modalità AI: ricerca sull'albero delle mosse
+#define ENGINE_SEARCH 0
+/// @brief Motore della modalità AI: le posizioni senza tessere speciali in mano sono risolte come scie del multigrafo dei valori
+#define ENGINE_GRAPH 1
+/// @brief Vertice del multigrafo dei valori per gli estremi a cui nessuna tessera normale può essere accostata
+#define GRAPH_DEAD 0
+/// @brief Motore della modalità AI euristico: ricerca a fascio, per le mani troppo grandi per la ricerca esatta
+#define ENGINE_BEAM 2
+/// @brief Numero predefinito di posizioni tenute ad ogni mossa dal motore a fascio
+#define BEAM_DEFAULT_WIDTH 64
+/// @brief Numero massimo di tipi di tessera in mano per cui il motore a fascio valuta esattamente le mani senza tessere speciali
+#define BEAM_TRAIL_KINDS 10
+/// @brief Vertice ausiliario che divide l'arco virtuale del campo nelle estensioni a sinistra e a destra
+#define GRAPH_SPLIT 7
+
+/// @brief Intervallo in millisecondi tra due aggiornamenti dell'avanzamento su un terminale
+#define PROGRESS_TTY_MS 250
+/// @brief Intervallo in millisecondi tra due righe di avanzamento quando l'output non è un terminale
+#define PROGRESS_LOG_MS 5000
+
+/// @brief Numero massimo di tessere dello stesso tipo in una mano
+#define HAND_KIND_MAX UINT8_MAX
+/// @brief Numero massimo di [11|11] in una mano, perché i valori del campo al netto dell'offset stiano in un int8_t
+#define HAND_SUM_MAX 127
+/// @brief Dimensione minima in byte di un blocco di Arena
+#define ARENA_BLOCK_SIZE (64*1024)
+/// @brief Identificativo e versione del formato del file della cache dei risultati
+#define CACHE_MAGIC "DOMCACH1"
+/// @brief Dimensione in byte dell'intestazione del file della cache
+#define CACHE_HEADER_SIZE 16
+/// @brief Identificativo e versione del formato del file della tablebase
+#define TABLEBASE_MAGIC "DOMTB001"
+/// @brief Dimensione in byte dell'intestazione del file della tablebase
+#define TABLEBASE_HEADER_SIZE 16
+/// @brief Numero di valori degli estremi coperti dalla tablebase (da 0 a 6)
+#define TABLEBASE_VALUES 7
+/// @brief Numero di stati degli estremi del campo: i due valori della prima e dell'ultima tessera
+#define TABLEBASE_ENDS (TABLEBASE_VALUES*TABLEBASE_VALUES*TABLEBASE_VALUES*TABLEBASE_VALUES)
+/// @brief Numero di stati degli estremi per le mani senza [11|11] e [12|21], che dipendono solo dai valori esterni
+#define TABLEBASE_OUTER (TABLEBASE_VALUES*TABLEBASE_VALUES)
+/// @brief Numero di classi di tessere della tablebase: i 21 tipi normali canonici più le 3 tessere speciali
+#define TABLEBASE_CLASSES 24
+/// @brief Numero di classi di tessere che non leggono i valori interni degli estremi: le normali e la [0|0]
+#define TABLEBASE_PLAIN_CLASSES 22
+/// @brief Numero massimo di tessere in mano coperte dalla tablebase
+#define TABLEBASE_MAX_TILES DOMINO_TABLEBASE_MAX_TILES
+
+/// @brief Mano senza tessere speciali
+#define MIX_PLAIN DOMINO_MIX_PLAIN
+/// @brief Mano con tutti i tipi di tessera equiprobabili
+#define MIX_UNIFORM DOMINO_MIX_UNIFORM
+/// @brief Mano con un terzo di tessere speciali
+#define MIX_SPECIAL DOMINO_MIX_SPECIAL
+
+/**
+ * @struct Tile
+ * @brief Definisce il tipo Tile: rappresenta una singola tessera di gioco
+*/
+typedef struct {
+  /** Valore sinistro della tessera */
+  int left; 
+  /** Valore destro della tessera */
+  int right;
+} Tile;
+
+/**
+ * @struct ArenaBlock
+ * @brief Definisce il tipo ArenaBlock: un blocco di memoria di un Arena, da cui le allocazioni vengono prese in ordine
+*/
+typedef struct ArenaBlock {
+  /** Blocco successivo nella lista */
+  struct ArenaBlock* next;
+  /** Dimensione in byte dell'area dati */
+  size_t size;
+  /** Byte già assegnati dell'area dati */
+  size_t used;
+  /** Area dati, allineata per qualsiasi tipo */
+  max_align_t data[];
+} ArenaBlock;
+
+/**
+ * @struct Arena
+ * @brief Definisce il tipo Arena: allocatore a blocchi le cui allocazioni vengono rilasciate tutte insieme.
+ * I blocchi non vengono restituiti al sistema finché l'Arena non viene distrutto, così le risoluzioni successive
+ * riusano la stessa memoria senza chiamare malloc
+*/
+typedef struct {
+  /** Primo blocco */
+  ArenaBlock* head;
+  /** Blocco da cui vengono prese le allocazioni */
+  ArenaBlock* current;
+  /** Dimensione minima di un nuovo blocco */
+  size_t block_size;
+} Arena;
+
+/**
+ * @struct ArenaMark
+ * @brief Definisce il tipo ArenaMark: un punto dell'Arena a cui è possibile tornare rilasciando le allocazioni successive
+*/
+typedef struct {
+  /** Blocco attuale al momento del segno */
+  ArenaBlock* block;
+  /** Byte usati del blocco al momento del segno */
+  size_t used;
+} ArenaMark;
+
+/**
+ * @struct PackedTile
+ * @brief Definisce il tipo PackedTile: una tessera del campo in 2 byte, con i valori memorizzati al netto dell'offset
+ * del campo. Il tipo della tessera non basta a descriverla, perché [11|11] e [12|21] prendono i valori di quella adiacente
+*/
+typedef struct {
+  /** Valore sinistro al netto dell'offset */
+  int8_t left;
+  /** Valore destro al netto dell'offset */
+  int8_t right;
+} PackedTile;
+
+/**
+ * @struct deque
+ * @brief Definisce il tipo deque: buffer circolare di PackedTile usato per il campo di gioco, con inserimento e rimozione in O(1) ad entrambi gli estremi
+*/
+typedef struct {
+  /** Dimensione attuale del deque */
+  size_t size;
+  /** Capacità totale del deque, sempre una potenza di 2 */
+  size_t capacity;
+  /** Posizione nel buffer del primo elemento */
+  size_t head;
+  /** Buffer circolare di PackedTile */
+  PackedTile* data;
+  /** Capacità sotto la quale il deque non viene ridotto */
+  size_t reserved;
+  /** Arena da cui viene presa la memoria (NULL se allocata con malloc) */
+  Arena* arena;
+} deque;
+
+/**
+ * @struct Field
+ * @brief Definisce il tipo Field: il campo di gioco. Una [11|11] non riscrive tutte le tessere ma incrementa offset:
+ * le tessere sono memorizzate al netto dell'offset presente quando sono state inserite e il valore reale si ottiene sommandolo
+*/
+typedef struct {
+  /** Tessere nel campo, memorizzate al netto di offset */
+  deque* tiles;
+  /** Valore da aggiungere ad entrambe le metà delle tessere memorizzate per ottenere i valori reali */
+  int offset;
+  /** Somma dei valori reali di tutte le tessere nel campo */
+  int total;
+} Field;
+
+/**
+ * @struct Hand
+ * @brief Definisce il tipo Hand: la mano del giocatore memorizzata come numero di tessere per ogni tipo.
+ * Il tipo di una tessera normale [l|r] è (l-1)*6 + (r-1), seguono SUM_KIND, ANY_KIND e MIRROR_KIND
+*/
+typedef struct {
+  /** Numero di tessere in mano per ogni tipo, al più HAND_KIND_MAX: la mano intera occupa una linea di cache */
+  uint8_t count[TILE_KINDS];
+  /** Bitmask dei tipi presenti in mano: il bit k è acceso se count[k] > 0 */
+  uint64_t present;
+  /** Numero totale di tessere in mano */
+  size_t size;
+  /** Somma dei valori delle tessere normali in mano */
+  int pips;
+} Hand;
+
+/**
+ * @struct Rng
+ * @brief Definisce il tipo Rng: generatore pseudo-casuale xoshiro256**. Ogni thread usa il proprio Rng,
+ * quindi la generazione non ha stato globale
+*/
+typedef struct {
+  /** Stato del generatore */
+  uint64_t s[4];
+} Rng;
+
+/**
+ * @struct KindSampler
+ * @brief Definisce il tipo KindSampler: tabella alias di Walker che estrae un tipo di tessera con probabilità
+ * proporzionale al suo peso usando un solo numero casuale
+*/
+typedef struct {
+  /** Soglia (su 2^32) sotto la quale si sceglie la colonna stessa invece del suo alias */
+  uint32_t threshold[TILE_KINDS];
+  /** Tipo alternativo di ogni colonna */
+  uint8_t alias[TILE_KINDS];
+} KindSampler;
+
+/**
+ * @struct Undo
+ * @brief Definisce il tipo Undo: registra cosa ha modificato una mossa, per poterla annullare durante la ricerca AI
+*/
+typedef struct {
+  /** Tipo della tessera rimossa dalla mano */
+  int kind;
+  /** Lato del campo in cui è stata inserita la tessera ('S', 'L' o 'R') */
+  char pos;
+  /** true se la tessera era una [11|11] e ha incrementato di 1 tutto il campo */
+  bool sum;
+  /** Punteggio del campo prima della mossa */
+  int total;
+} Undo;
+
+/**
+ * @struct Move
+ * @brief Definisce il tipo Move: una mossa, cioè quale tessera inserire, in che lato del campo e in che verso
+*/
+typedef struct {
+  /** Tipo della tessera */
+  uint8_t kind;
+  /** Lato del campo ('S', 'L' o 'R') */
+  char pos;
+  /** true se la tessera va inserita invertita */
+  bool flip;
+} Move;
+
+/**
+ * @struct MoveRecord
+ * @brief Definisce il tipo MoveRecord: una mossa giocata insieme ai valori che la tessera ha assunto nel campo
+*/
+typedef struct {
+  /** Mossa giocata */
+  Move move;
+  /** Valore sinistro della tessera nel campo subito dopo la mossa */
+  uint8_t left;
+  /** Valore destro della tessera nel campo subito dopo la mossa */
+  uint8_t right;
+} MoveRecord;
+
+/**
+ * @struct MoveStack
+ * @brief Definisce il tipo MoveStack: pila di mosse a capacità fissa, allocata una volta per ricerca
+*/
+typedef struct {
+  /** Array di mosse */
+  MoveRecord* data;
+  /** Numero di mosse */
+  int size;
+  /** Capacità dell'array */
+  int capacity;
+} MoveStack;
+
+/**
+ * @struct TTEntry
+ * @brief Definisce il tipo TTEntry: una posizione già valutata dalla ricerca AI.
+ * I valori sono impacchettati in data e check contiene la chiave in XOR con data, così un elemento scritto a metà
+ * da un altro thread non corrisponde a nessuna chiave e la tabella può essere condivisa senza lock
+*/
+typedef struct {
+  /** Chiave della posizione in XOR con data (0 se l'elemento è vuoto) */
+  _Atomic uint64_t check;
+  /** Punteggio aggiuntivo sicuramente ottenibile (24 bit), limite superiore al punteggio aggiuntivo (24 bit) e numero di tessere in mano (16 bit) */
+  _Atomic uint64_t data;
+} TTEntry;
+
+/**
+ * @struct TTable
+ * @brief Definisce il tipo TTable: tabella delle trasposizioni a dimensione fissa, divisa in coppie di elementi
+*/
+typedef struct {
+  /** Array di elementi */
+  TTEntry* entries;
+  /** Numero di coppie di elementi meno 1 (il numero di coppie è una potenza di 2) */
+  size_t mask;
+} TTable;
+
+/**
+ * @struct Options
+ * @brief Definisce il tipo Options: le opzioni delle ricerche di un contesto, lette da DominoOptions
+*/
+typedef struct {
+  /** Memoria in MB della tabella delle trasposizioni */
+  size_t tt_mb;
+  /** Numero di thread della ricerca AI */
+  int threads;
+  /** Tempo massimo della ricerca AI in millisecondi (0 se illimitato) */
+  long time_ms;
+  /** Numero massimo di posizioni espanse dalla ricerca AI (0 se illimitato) */
+  uint64_t max_nodes;
+  /** File su cui scrivere le istantanee delle statistiche (NULL per non scriverle) */
+  FILE* stats;
+  /** Intervallo tra due istantanee delle statistiche in millisecondi */
+  long stats_interval;
+  /** File su cui mostrare l'avanzamento della ricerca (NULL per non mostrarlo) */
+  FILE* progress;
+  /** Motore della modalità AI (ENGINE_SEARCH, ENGINE_GRAPH o ENGINE_BEAM) */
+  int engine;
+  /** Numero di posizioni tenute ad ogni mossa dal motore a fascio */
+  int beam_width;
+  /** true se il risultato del motore a fascio va confrontato con l'ottimo della ricerca esatta */
+  bool beam_exact;
+  /** Cache persistente dei risultati, condivisa tra i contesti (NULL se non attiva) */
+  struct DominoCache* cache;
+  /** Tablebase condivisa da tutte le ricerche (NULL se non attiva) */
+  struct DominoTablebase const* tb;
+} Options;
+
+/**
+ * @struct Tablebase
+ * @brief Definisce il tipo Tablebase: il punteggio ottimo ancora realizzabile per ogni mano di al più tiles tessere
+ * e per ogni stato degli estremi del campo con valori da 0 a 6. Ogni elemento vale il punteggio meno 2*n per ogni
+ * [11|11] in mano, con n il numero di tessere nel campo: le tessere speciali sono sempre giocabili, quindi tutte le
+ * [11|11] vengono giocate e il resto del punteggio non dipende da n.
+ * Le mani sono ordinate per numero di tessere e poi per rango; quelle senza [11|11] e [12|21] vengono prima e hanno
+ * solo TABLEBASE_OUTER elementi, le altre TABLEBASE_ENDS
+*/
+typedef struct DominoTablebase {
+  /** Punteggi di tutte le mani (in sola lettura se il file è mappato) */
+  uint8_t* values;
+  /** File mappato (NULL se la tablebase è in generazione) */
+  void* map;
+  /** Dimensione della mappatura */
+  size_t map_size;
+  /** Numero massimo di tessere in mano coperte */
+  int tiles;
+  /** Coefficienti binomiali per il rango delle mani */
+  uint32_t binom[TABLEBASE_CLASSES+TABLEBASE_MAX_TILES+1][TABLEBASE_MAX_TILES+1];
+  /** Posizione in values delle mani di ogni numero di tessere; l'ultimo elemento è la dimensione totale */
+  size_t offset[TABLEBASE_MAX_TILES+2];
+  /** Numero di mani senza [11|11] e [12|21] per ogni numero di tessere */
+  size_t plain[TABLEBASE_MAX_TILES+1];
+} Tablebase;
+
+/**
+ * @struct Budget
+ * @brief Definisce il tipo Budget: i limiti di tempo e di posizioni di una ricerca AI, condivisi tra i thread
+*/
+typedef struct {
+  /** Istante in millisecondi oltre il quale la ricerca viene interrotta (0 se illimitato) */
+  long long deadline;
+  /** Numero massimo di posizioni espanse (0 se illimitato) */
+  uint64_t max_nodes;
+  /** Posizioni espanse da tutti i thread, aggiornato ogni BUDGET_CHECK posizioni */
+  atomic_ullong nodes;
+  /** true quando il budget è esaurito */
+  atomic_bool stop;
+} Budget;
+
+/**
+ * @struct Line
+ * @brief Definisce il tipo Line: la miglior partita completa trovata finora, condivisa tra i thread
+*/
+typedef struct {
+  /** Lock che protegge le mosse */
+  pthread_mutex_t lock;
+  /** Mosse dalla radice */
+  Move* moves;
+  /** Numero di mosse */
+  int length;
+  /** Punteggio totale della partita */
+  atomic_int total;
+} Line;
+
+/**
+ * @struct Progress
+ * @brief Definisce il tipo Progress: l'avanzamento di una ricerca AI, letto ad intervalli regolari da un thread separato
+ * che lo stampa senza rallentare la ricerca
+*/
+typedef struct {
+  /** Thread che stampa l'avanzamento */
+  pthread_t thread;
+  /** Lock usato con wake per interrompere l'attesa tra due aggiornamenti */
+  pthread_mutex_t lock;
+  /** Condizione segnalata quando la ricerca termina */
+  pthread_cond_t wake;
+  /** true quando la ricerca è terminata */
+  bool stop;
+  /** Posizioni espanse da tutti i thread, aggiornato ogni BUDGET_CHECK posizioni */
+  atomic_ullong nodes;
+  /** Sotto-alberi della radice completati */
+  atomic_long done;
+  /** Sotto-alberi della radice da esplorare */
+  atomic_long total;
+  /** Miglior punteggio totale trovato finora */
+  atomic_int* best;
+  /** Budget della ricerca (NULL se illimitato), usato per stimare il completamento */
+  Budget const* budget;
+  /** Istante di inizio della ricerca in millisecondi */
+  long long start_ms;
+  /** true se l'avanzamento viene riscritto sulla stessa riga di un terminale, false per righe di log */
+  bool tty;
+  /** File su cui viene stampato l'avanzamento */
+  FILE* out;
+} Progress;
+
+/**
+ * @struct Stats
+ * @brief Definisce il tipo Stats: i contatori della ricerca AI, compilati solo con -DDOMINO_STATS
+*/
+typedef struct {
+  /** Posizioni espanse per numero di mosse dalla radice */
+  uint64_t depth_nodes[STATS_DEPTHS];
+  /** Posizioni senza mosse possibili */
+  uint64_t leaves;
+  /** Chiamate a possible_moves */
+  uint64_t possible_moves_calls;
+  /** Chiamate a list_moves, che sostituisce i controlli con valid_move tessera per tessera */
+  uint64_t list_moves_calls;
+  /** Posizioni trovate nella tabella delle trasposizioni */
+  uint64_t tt_hits;
+  /** Posizioni lette dalla tablebase */
+  uint64_t tb_hits;
+  /** Tessere speciali giocate, per tipo (somma, qualsiasi, specchio) */
+  uint64_t special_plays[3];
+  /** Mosse dalla radice, nell'ordine in cui vengono esplorate */
+  Move root_moves[MAX_MOVES];
+  /** Tempo in microsecondi speso in ogni mossa dalla radice (solo ricerca con un thread) */
+  long long root_us[MAX_MOVES];
+  /** Numero di mosse dalla radice */
+  int root_count;
+  /** Istante di inizio della ricerca in millisecondi */
+  long long start_ms;
+  /** Istante della prossima istantanea in millisecondi */
+  long long next_snapshot;
+  /** Intervallo tra due istantanee in millisecondi (0 se non vanno stampate) */
+  long interval_ms;
+  /** File su cui vengono scritte le istantanee (NULL se non vanno stampate) */
+  FILE* out;
+} Stats;
+
+/**
+ * @struct Search
+ * @brief Definisce il tipo Search: lo stato della ricerca AI
+*/
+typedef struct {
+  /** Campo di gioco */
+  Field* field;
+  /** Mano del giocatore */
+  Hand* hand;
+  /** Chiave Zobrist della mano, aggiornata ad ogni mossa */
+  uint64_t hand_key;
+  /** Tabella delle trasposizioni, condivisa tra i thread */
+  TTable* tt;
+  /** Miglior punteggio totale trovato finora, condiviso tra i thread e usato per scartare i rami che non possono superarlo */
+  atomic_int* best;
+  /** false se i rami vanno esplorati anche quando non possono superare best (ricostruzione della miglior partita) */
+  bool use_best;
+  /** true se le posizioni senza tessere speciali in mano vanno risolte con trail_value */
+  bool graph;
+  /** Tablebase delle posizioni con poche tessere in mano (NULL se non attiva) */
+  Tablebase const* tb;
+  /** Budget della ricerca (NULL se illimitato) */
+  Budget* budget;
+  /** Miglior partita completa trovata (NULL se non va registrata) */
+  Line* line;
+  /** Mosse giocate dalla radice fino alla posizione attuale */
+  Move* path;
+  /** Memoria per i vertici della scia costruita da trail_value, 2*(tessere+3) elementi allocati con path */
+  uint8_t* trail;
+  /** Numero di mosse in path */
+  int depth;
+  /** Numero massimo di mosse dalla radice oltre il quale la partita viene completata con mosse greedy (INT_MAX se illimitato) */
+  int limit;
+  /** Numero di posizioni completate con mosse greedy perché oltre limit */
+  uint64_t horizons;
+  /** Avanzamento da aggiornare (NULL se non va mostrato) */
+  Progress* progress;
+#ifdef DOMINO_STATS
+  /** Contatori della ricerca */
+  Stats stats;
+#endif
+  /** Numero di posizioni espanse */
+  uint64_t nodes;
+  /** Numero di rami scartati perché il loro limite superiore non supera il miglior punteggio */
+  uint64_t cutoffs;
+} Search;
+
+/**
+ * @struct HintEngine
+ * @brief Definisce il tipo HintEngine: la ricerca in background della modalità interattiva, che analizza la posizione
+ * attuale mentre il giocatore pensa. La tabella delle trasposizioni e la miglior partita trovata vengono conservate
+ * tra un turno e l'altro, così le posizioni già analizzate non vanno ricalcolate
+*/
+typedef struct {
+  /** Thread della ricerca */
+  pthread_t thread;
+  /** Lock che protegge la posizione da analizzare e lo stato del thread */
+  pthread_mutex_t lock;
+  /** Condizione segnalata quando arriva una nuova posizione o il thread termina un'analisi */
+  pthread_cond_t wake;
+  /** true se c'è una nuova posizione da analizzare */
+  bool pending;
+  /** true mentre il thread sta analizzando una posizione */
+  bool busy;
+  /** true quando il thread deve terminare */
+  bool quit;
+  /** true se la miglior partita in line è dimostrata ottima */
+  bool proven;
+  /** Copia del campo di gioco analizzato */
+  Field* field;
+  /** Copia della mano analizzata */
+  Hand hand;
+  /** Opzioni della ricerca */
+  Options opt;
+  /** Tabella delle trasposizioni, conservata tra i turni */
+  TTable tt;
+  /** Budget senza limiti, usato solo per interrompere la ricerca quando il giocatore muove */
+  Budget budget;
+  /** Miglior partita trovata dalla posizione analizzata */
+  Line line;
+  /** Miglior punteggio totale trovato */
+  atomic_int best;
+} HintEngine;
+
+/**
+ * @struct Task
+ * @brief Definisce il tipo Task: un sotto-albero della ricerca parallela, identificato dalle mosse che lo raggiungono dalla radice
+*/
+typedef struct {
+  /** Mosse dalla radice */
+  Move moves[SPLIT_DEPTH];
+  /** Numero di mosse */
+  int length;
+} Task;
+
+/**
+ * @struct TaskDeque
+ * @brief Definisce il tipo TaskDeque: coda di Task di un thread. Il thread proprietario inserisce e preleva in coda,
+ * gli altri thread rubano dalla testa i Task più vicini alla radice
+*/
+typedef struct {
+  /** Lock che protegge la coda */
+  pthread_mutex_t lock;
+  /** Array di Task */
+  Task* tasks;
+  /** Indice del primo Task */
+  size_t head;
+  /** Indice successivo all'ultimo Task */
+  size_t tail;
+  /** Capacità totale dell'array */
+  size_t capacity;
+} TaskDeque;
+
+/**
+ * @struct Result
+ * @brief Definisce il tipo Result: il risultato della ricerca AI su una mano
+*/
+typedef struct {
+  /** Punteggio totale della partita trovata */
+  int total;
+  /** Mosse della partita trovata */
+  MoveStack line;
+  /** Numero di posizioni espanse */
+  uint64_t nodes;
+  /** Numero di rami scartati */
+  uint64_t cutoffs;
+  /** true se il punteggio è dimostrato ottimo */
+  bool proven;
+  /** Punteggio ottimo noto con cui confrontare quello del motore a fascio (-1 se non noto) */
+  int optimum;
+#ifdef DOMINO_STATS
+  /** Contatori della ricerca */
+  Stats stats;
+#endif
+} Result;
+
+/**
+ * @struct CacheRecord
+ * @brief Definisce il tipo CacheRecord: un risultato ottimo salvato nel file della cache, seguito dalle sue mosse
+ * codificate in 2 byte ciascuna (tipo, poi lato nei bit 0-1 e verso nel bit 2). La lunghezza è multipla di 8
+ * così che i record mappati in memoria restino allineati
+*/
+typedef struct {
+  /** Lunghezza in byte del record, mosse e riempimento compresi */
+  uint32_t length;
+  /** Checksum di tutto il record dopo questo campo, per riconoscere record scritti a metà */
+  uint32_t checksum;
+  /** Impronta della mano */
+  uint64_t key;
+  /** Istante in secondi dell'ultimo uso, usato per scegliere quali record eliminare */
+  uint64_t stamp;
+  /** Punteggio ottimo */
+  int32_t total;
+  /** Numero di mosse */
+  uint16_t n_moves;
+  /** Numero di tessere per tipo canonico: [a|b] e [b|a] sono contate insieme */
+  uint16_t count[TILE_KINDS];
+} CacheRecord;
+
+/**
+ * @struct CacheSlot
+ * @brief Definisce il tipo CacheSlot: un elemento dell'indice in memoria della cache
+*/
+typedef struct {
+  /** Record, nel file mappato o copiato in memoria (NULL se l'elemento è vuoto) */
+  CacheRecord const* record;
+  /** Istante dell'ultimo uso da parte di questo processo */
+  uint64_t stamp;
+} CacheSlot;
+
+/**
+ * @struct CacheIndex
+ * @brief Definisce il tipo CacheIndex: tabella hash ad indirizzamento aperto dei record della cache
+*/
+typedef struct {
+  /** Array di elementi */
+  CacheSlot* slots;
+  /** Numero di elementi meno 1 (il numero di elementi è una potenza di 2) */
+  size_t mask;
+  /** Numero di elementi occupati */
+  size_t used;
+} CacheIndex;
+
+/**
+ * @struct Cache
+ * @brief Definisce il tipo Cache: la cache persistente dei risultati ottimi, indicizzata per mano canonica.
+ * Il file viene mappato in sola lettura all'apertura; i nuovi record vengono aggiunti in coda sotto un lock sul file
+ * path.lock, così che più processi possano scriverla insieme
+*/
+typedef struct DominoCache {
+  /** Percorso del file, copiato all'apertura */
+  char* path;
+  /** Descrittore del file di lock, aperto per tutta la vita della cache */
+  int lock_fd;
+  /** Dimensione massima in byte del file */
+  size_t max_bytes;
+  /** Lock che protegge indice e record aggiunti tra i thread del processo */
+  pthread_mutex_t lock;
+  /** File mappato in memoria (NULL se il file era vuoto o assente) */
+  uint8_t const* map;
+  /** Dimensione della mappatura */
+  size_t map_size;
+  /** Fine dell'ultimo record valido del file mappato */
+  size_t valid_end;
+  /** Indice dei record */
+  CacheIndex index;
+  /** Record aggiunti da questo processo dopo la mappatura */
+  CacheRecord** added;
+  /** Numero di record aggiunti */
+  size_t n_added;
+  /** Capacità dell'array dei record aggiunti */
+  size_t added_capacity;
+} Cache;
+
+struct Pool;
+
+/**
+ * @struct Worker
+ * @brief Definisce il tipo Worker: un thread della ricerca parallela con il proprio campo, la propria mano e la propria coda di Task
+*/
+typedef struct {
+  /** Pool di cui fa parte il thread */
+  struct Pool* pool;
+  /** Indice del thread nel pool */
+  int id;
+  /** Thread */
+  pthread_t thread;
+  /** Coda di Task del thread */
+  TaskDeque queue;
+  /** Stato della ricerca del thread */
+  Search search;
+} Worker;
+
+/**
+ * @struct BeamNode
+ * @brief Definisce il tipo BeamNode: una posizione tenuta dal motore a fascio
+*/
+typedef struct {
+  /** Campo di gioco, preso dall'Arena della mossa */
+  Field* field;
+  /** Mano del giocatore */
+  Hand hand;
+  /** Chiave della mano */
+  uint64_t hand_key;
+  /** Punteggio accumulato */
+  int total;
+  /** Indice del passo da cui si arriva nella storia delle mosse (-1 per la posizione iniziale) */
+  int step;
+} BeamNode;
+
+/**
+ * @struct BeamCandidate
+ * @brief Definisce il tipo BeamCandidate: una mossa valutata dal motore a fascio, prima di scegliere quali tenere
+*/
+typedef struct {
+  /** Indice della posizione di partenza */
+  int parent;
+  /** Mossa */
+  Move move;
+  /** Valutazione della posizione raggiunta */
+  int eval;
+  /** Chiave della posizione raggiunta */
+  uint64_t key;
+} BeamCandidate;
+
+/**
+ * @struct BeamStep
+ * @brief Definisce il tipo BeamStep: un passo della storia delle mosse del motore a fascio, da cui si ricostruisce la
+ * partita trovata
+*/
+typedef struct {
+  /** Indice del passo precedente (-1 se è la prima mossa) */
+  int prev;
+  /** Mossa giocata */
+  Move move;
+} BeamStep;
+
+/**
+ * @struct TablebaseJob
+ * @brief Definisce il tipo TablebaseJob: le mani con lo stesso numero di tessere risolte in parallelo dalla generazione
+ * della tablebase
+*/
+typedef struct {
+  /** Tablebase in generazione */
+  Tablebase* tb;
+  /** Numero di tessere delle mani */
+  int size;
+  /** Numero di mani */
+  size_t count;
+  /** Rango, tra le mani della stessa dimensione, del prossimo gruppo di mani da risolvere */
+  atomic_size_t next;
+} TablebaseJob;
+
+/**
+ * @struct TablebaseWorker
+ * @brief Definisce il tipo TablebaseWorker: un thread della generazione della tablebase, con il proprio campo
+*/
+typedef struct {
+  /** Livello in generazione */
+  TablebaseJob* job;
+  /** Campo del thread, allocato prima di avviarlo e riusato per tutti i livelli */
+  Field* field;
+  /** Thread */
+  pthread_t thread;
+} TablebaseWorker;
+
+/**
+ * @struct DominoSolver
+ * @brief Definisce il contesto del risolutore della libreria: opzioni, tabella delle trasposizioni, memoria e
+ * generatore casuale di chi lo usa, senza stato condiviso con gli altri contesti
+*/
+struct DominoSolver {
+  /** Opzioni delle ricerche, con la cache e la tablebase indicate da chi ha creato il contesto */
+  Options opt;
+  /** Tabella delle trasposizioni, condivisa da tutte le ricerche del contesto */
+  TTable tt;
+  /** Memoria del campo e delle mani, riusata da una ricerca all'altra */
+  Arena arena;
+  /** Campo di gioco, vuoto tra una ricerca e l'altra */
+  Field* field;
+  /** Segno dell'Arena dopo il campo, a cui si torna ad ogni ricerca */
+  ArenaMark start;
+  /** Generatore casuale del contesto */
+  Rng rng;
+  /** Estrazione dei tipi di tessera per le mani casuali, tutti equiprobabili */
+  KindSampler sampler;
+};
+
+/**
+ * @struct DominoGame
+ * @brief Definisce la partita della libreria: campo e mano giocati mossa per mossa e, se attivi, i suggerimenti
+*/
+struct DominoGame {
+  /** Campo di gioco */
+  Field* field;
+  /** Mano del giocatore */
+  Hand hand;
+  /** Opzioni del contesto da cui è stata creata, usate dai suggerimenti */
+  Options opt;
+  /** Ricerca dei suggerimenti in background (NULL se non attiva) */
+  HintEngine* hints;
+};
+
+#ifdef DOMINO_STATS
+/**
+ * @struct DominoStats
+ * @brief Definisce i contatori restituiti con un DominoResult
+*/
+struct DominoStats {
+  /** Contatori della ricerca */
+  Stats stats;
+  /** Numero di posizioni espanse */
+  uint64_t nodes;
+  /** Numero di rami scartati */
+  uint64_t cutoffs;
+};
+#endif
+
+/**
+ * @struct Pool
+ * @brief Definisce il tipo Pool: l'insieme dei thread della ricerca parallela
+*/
+typedef struct Pool {
+  /** Numero di thread */
+  int threads;
+  /** Array di thread */
+  Worker* workers;
+  /** Numero di Task creati e non ancora completati */
+  atomic_long pending;
+  /** Numero di Task creati */
+  atomic_long created;
+  /** Numero di Task completati */
+  atomic_long done;
+  /** Numero di thread senza lavoro */
+  atomic_int idle;
+  /** Numero di Task in coda, non ancora prelevati da nessun thread */
+  atomic_long queued;
+  /** Lock con cui i thread senza lavoro attendono wake */
+  pthread_mutex_t lock;
+  /** Segnalata quando vengono messi in coda nuovi Task e quando l'ultimo Task è completato */
+  pthread_cond_t wake;
+} Pool;
+
+// Funzioni per la gestione di Arena
+
+/**
+ * @brief Funzione che inizializza un Arena con un primo blocco vuoto
+ * @param arena L'Arena da inizializzare
+ * @param block_size Dimensione minima in byte dei blocchi
+ * @return true se l'allocazione è riuscita, false se la memoria non basta
+*/
+static bool arena_init(Arena* arena, size_t block_size);
+
+/**
+ * @brief Funzione che restituisce al sistema tutti i blocchi dell'Arena
+ * @param arena L'Arena da distruggere
+*/
+static void arena_free(Arena* arena);
+
+/**
+ * @brief Funzione che alloca memoria dall'Arena, aggiungendo un blocco solo se quelli liberi non bastano
+ * @param arena L'Arena da cui allocare (NULL per usare malloc)
+ * @param bytes Numero di byte richiesti
+ * @return La memoria allocata, NULL se la memoria non basta
+*/
+static void* arena_alloc(Arena* arena, size_t bytes);
+
+/**
+ * @brief Funzione che rilascia un'allocazione: con un Arena non fa nulla, perché la memoria viene rilasciata
+ * insieme alle altre con arena_rewind o arena_reset
+ * @param arena L'Arena da cui è stata allocata p (NULL se allocata con malloc)
+ * @param p L'allocazione da rilasciare
+*/
+static void arena_release(Arena* arena, void* p);
+
+/**
+ * @brief Funzione che restituisce il punto attuale dell'Arena
+ * @param arena L'Arena (NULL per un segno vuoto)
+ * @return Il segno
+*/
+static ArenaMark arena_mark(Arena const* arena);
+
+/**
+ * @brief Funzione che rilascia tutte le allocazioni successive al segno fornito
+ * @param arena L'Arena (NULL se non c'è nulla da rilasciare)
+ * @param mark Segno restituito da arena_mark
+*/
+static void arena_rewind(Arena* arena, ArenaMark mark);
+
+/**
+ * @brief Funzione che rilascia tutte le allocazioni dell'Arena, conservandone i blocchi
+ * @param arena L'Arena da svuotare
+*/
+static void arena_reset(Arena* arena);
+
+// Funzioni per la gestione di MoveStack
+
+/**
+ * @brief Alloca lo spazio per capacity mosse
+ * @param ms La pila da inizializzare
+ * @param capacity Il numero massimo di mosse
+ * @return true se l'allocazione è riuscita, false se la memoria non basta
+*/
+static bool move_stack_init(MoveStack* ms, int capacity);
+
+/**
+ * @brief Libera lo spazio della pila
+ * @param ms La pila da liberare
+*/
+static void move_stack_free(MoveStack* ms);
+
+/**
+ * @brief Inserisce una mossa appena giocata, leggendo dal campo i valori assunti dalla tessera.
+ * La pila non deve essere piena
+ * @param ms La pila
+ * @param field Il campo su cui la mossa è stata giocata
+ * @param move La mossa
+*/
+static void move_stack_push(MoveStack* ms, Field const* field, Move const* move);
+
+
+// Funzioni per la gestione di deque
+
+
+/**
+ * @brief Funzione per l'allocazione di un nuovo deque di PackedTile la cui memoria viene presa dall'Arena fornito
+ * @param arena L'Arena (NULL per usare malloc)
+ * @return Il nuovo deque allocato, NULL se la memoria non basta
+*/
+static deque* create_deque_in(Arena* arena);
+
+/**
+ * @brief Funzione per la deallocazione del deque passato
+ * @param d Il deque da deallocare
+*/
+static void free_deque(deque* d);
+
+/**
+ * @brief Modifica la capacità del deque fornito, riportando il primo elemento all'inizio del buffer
+ * @param d Il deque di cui si vuole modificare la capacità
+ * @param new_capacity La nuova capacità del deque, una potenza di 2 non minore della dimensione
+ * @return true se il buffer è stato allocato, false se la memoria non basta e il deque è rimasto com'era
+*/
+static bool resize_deque(deque* d, size_t new_capacity);
+
+/**
+ * @brief Porta la capacità del deque ad almeno n elementi e impedisce che venga ridotta sotto di essa,
+ * così una ricerca che non supera n tessere nel campo non rialloca mai il buffer
+ * @param d Il deque da modificare
+ * @param n Numero di elementi da riservare
+ * @return true se la capacità è stata riservata, false se la memoria non basta
+*/
+static bool reserve_deque(deque* d, size_t n);
+
+/**
+ * @brief Inserisce un elemento in coda al deque d, la cui capacità va riservata prima con reserve_deque
+ * @param d Il deque da modificare
+ * @param el L'elemento da inserire in coda
+*/
+static void push_back_deque(deque* d, PackedTile el);
+
+/**
+ * @brief Inserisce un elemento in testa al deque d, la cui capacità va riservata prima con reserve_deque
+ * @param d Il deque da modificare
+ * @param el L'elemento da inserire in testa
+*/
+static void push_front_deque(deque* d, PackedTile el);
+
+/**
+ * @brief Elimina l'ultimo elemento del deque d
+ * @param d Il deque da modificare
+*/
+static void pop_back_deque(deque* d);
+
+/**
+ * @brief Elimina il primo elemento del deque d
+ * @param d Il deque da modificare
+*/
+static void pop_front_deque(deque* d);
+
+/**
+ * @brief Restituisce un puntatore all'elemento del deque d all'indice fornito
+ * @param d Il deque
+ * @param index L'indice dell'elemento, a partire dalla testa
+ * @return Il puntatore all'elemento
+*/
+static PackedTile* get_deque(deque const* d, size_t index);
+
+
+
+// Funzioni per la gestione di Field
+
+/**
+ * @brief Funzione per l'allocazione di un nuovo campo di gioco vuoto
+ * @return Il nuovo campo allocato, NULL se la memoria non basta
+*/
+static Field* create_field();
+
+/**
+ * @brief Funzione per l'allocazione di un nuovo campo di gioco vuoto la cui memoria viene presa dall'Arena fornito
+ * @param arena L'Arena (NULL per usare malloc)
+ * @return Il nuovo campo allocato, NULL se la memoria non basta
+*/
+static Field* create_field_in(Arena* arena);
+
+/**
+ * @brief Funzione per la deallocazione del campo passato
+ * @param field Il campo da deallocare
+*/
+static void free_field(Field* field);
+
+/**
+ * @brief Restituisce la tessera del campo all'indice fornito, con i valori reali
+ * @param field Il campo di gioco
+ * @param index L'indice della tessera, a partire da sinistra
+ * @return La tessera
+*/
+static Tile field_at(Field const* field, size_t index);
+
+/**
+ * @brief Restituisce la prima tessera del campo, che non deve essere vuoto, con i valori reali
+ * @param field Il campo di gioco
+ * @return La prima tessera
+*/
+static Tile field_front(Field const* field);
+
+/**
+ * @brief Restituisce l'ultima tessera del campo, che non deve essere vuoto, con i valori reali
+ * @param field Il campo di gioco
+ * @return L'ultima tessera
+*/
+static Tile field_back(Field const* field);
+
+/**
+ * @brief Inserisce una tessera ad un estremo del campo
+ * @param field Il campo di gioco
+ * @param pos L'estremo in cui inserire la tessera ('L' per sinistra, altrimenti destra)
+ * @param el La tessera, con i valori reali
+*/
+static void field_push(Field* field, char pos, Tile el);
+
+/**
+ * @brief Elimina la tessera ad un estremo del campo
+ * @param field Il campo di gioco
+ * @param pos L'estremo da cui eliminare la tessera ('L' per sinistra, altrimenti destra)
+*/
+static void field_pop(Field* field, char pos);
+
+// Funzioni per la gestione di Hand
+
+/**
+ * @brief Calcola il tipo di una tessera
+ * @param el La tessera
+ * @return Il tipo della tessera, -1 se non è una tessera del gioco
+*/
+static int tile_kind(Tile el);
+
+/**
+ * @brief Restituisce la tessera corrispondente al tipo fornito
+ * @param kind Il tipo di tessera
+ * @return La tessera
+*/
+static Tile kind_tile(int kind);
+
+/**
+ * @brief Restituisce la bitmask dei tipi di tessera normali che contengono il valore v
+ * @param v Il valore cercato
+ * @return La bitmask dei tipi, 0 se v non è compreso tra 1 e 6
+*/
+static uint64_t value_kinds(int v);
+
+/**
+ * @brief Inizializza una mano vuota
+ * @param hand La mano da inizializzare
+*/
+static void hand_init(Hand* hand);
+
+/**
+ * @brief Aggiunge una tessera alla mano
+ * @param hand La mano da modificare
+ * @param kind Il tipo della tessera da aggiungere
+*/
+static void hand_add(Hand* hand, int kind);
+
+/**
+ * @brief Rimuove una tessera dalla mano, che deve essere presente
+ * @param hand La mano da modificare
+ * @param kind Il tipo della tessera da rimuovere
+*/
+static void hand_remove(Hand* hand, int kind);
+
+
+/**
+ * @brief Restituisce la somma dei valori di una tessera del tipo fornito, 0 per le tessere speciali
+ * @param kind Il tipo di tessera
+ * @return La somma dei valori della tessera
+*/
+static int kind_pips(int kind);
+
+/**
+ * @brief Restituisce il tipo canonico di una tessera: [a|b] e [b|a] vengono girate per adattarsi al campo,
+ * quindi sono la stessa tessera per il resto della partita e hanno come tipo canonico quello con a <= b
+ * @param kind Il tipo di tessera
+ * @return Il tipo canonico
+*/
+static int canonical_kind(int kind);
+
+/**
+ * @brief Controlla se il campo è simmetrico, cioè se letto da destra a sinistra ha gli stessi estremi:
+ * in questo caso ogni mossa a sinistra equivale a una mossa a destra
+ * @param field Il campo di gioco
+ * @return true se la prima tessera è l'inversa dell'ultima
+*/
+static bool symmetric_field(Field const* field);
+
+/**
+ * @brief Indica se la mano contiene una tessera che può essere affiancata ad un estremo di valore v
+ * @param hand La mano
+ * @param v Il valore dell'estremo del campo
+ * @return true se esiste una tessera compatibile, false altrimenti
+*/
+static bool hand_matches(Hand const* hand, int v);
+
+// Funzioni per la gestione della tabella delle trasposizioni
+
+/**
+ * @brief Alloca una tabella delle trasposizioni che occupa al massimo mb megabyte
+ * @param tt La tabella da inizializzare
+ * @param mb La memoria massima in MB
+ * @return true se l'allocazione è riuscita, false se la memoria non basta
+*/
+static bool tt_create(TTable* tt, size_t mb);
+
+/**
+ * @brief Dealloca la tabella delle trasposizioni
+ * @param tt La tabella da deallocare
+*/
+static void tt_free(TTable* tt);
+
+/**
+ * @brief Cerca una posizione nella tabella delle trasposizioni
+ * @param tt La tabella in cui cercare
+ * @param key La chiave della posizione
+ * @param lo Puntatore in cui viene scritto il punteggio aggiuntivo sicuramente ottenibile, se trovato
+ * @param hi Puntatore in cui viene scritto il limite superiore al punteggio aggiuntivo, se trovato
+ * @return true se la posizione è presente, false altrimenti
+*/
+static bool tt_probe(TTable const* tt, uint64_t key, int* lo, int* hi);
+
+/**
+ * @brief Memorizza una posizione nella tabella delle trasposizioni
+ * @param tt La tabella da modificare
+ * @param key La chiave della posizione
+ * @param lo Il punteggio aggiuntivo sicuramente ottenibile dalla posizione
+ * @param hi Il limite superiore al punteggio aggiuntivo ottenibile dalla posizione
+ * @param depth Il numero di tessere in mano nella posizione
+*/
+static void tt_store(TTable* tt, uint64_t key, int lo, int hi, int depth);
+
+/**
+ * @brief Mescola i bit di x (finalizzatore di splitmix64), usato per costruire le chiavi delle posizioni
+ * @param x Il valore da mescolare
+ * @return Il valore mescolato
+*/
+static uint64_t mix64(uint64_t x);
+
+/**
+ * @brief Calcola la chiave Zobrist di un tipo di tessera, uguale per [a|b] e [b|a]
+ * @param kind Il tipo di tessera
+ * @return La chiave del tipo
+*/
+static uint64_t kind_key(int kind);
+
+/**
+ * @brief Calcola la chiave Zobrist di una mano come somma delle chiavi delle sue tessere, indipendente dall'ordine
+ * @param hand La mano del giocatore
+ * @return La chiave della mano
+*/
+static uint64_t hand_key(Hand const* hand);
+
+/**
+ * @brief Calcola la chiave di una posizione dati il campo e la chiave della mano
+ * @param field campo di gioco
+ * @param hand_key chiave della mano
+ * @return La chiave della posizione
+*/
+static uint64_t field_key(Field const* field, uint64_t hand_key);
+
+/**
+ * @brief Calcola la chiave della posizione attuale della ricerca: mano, tessere agli estremi del campo e numero di tessere nel campo
+ * @param s Lo stato della ricerca
+ * @return La chiave della posizione
+*/
+static uint64_t position_key(Search const* s);
+
+//Funzioni per la generazione casuale
+
+/**
+ * @brief Inizializza un generatore: generatori con lo stesso seme e stream diversi producono sequenze che non si
+ * sovrappongono, perché ogni stream avanza di 2^128 numeri rispetto al precedente
+ * @param rng Il generatore da inizializzare
+ * @param seed Il seme
+ * @param stream L'indice dello stream, ad esempio l'indice del thread
+*/
+static void rng_seed(Rng* rng, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief Restituisce il prossimo numero casuale del generatore
+ * @param rng Il generatore
+ * @return Un numero casuale a 64 bit
+*/
+static uint64_t rng_next(Rng* rng);
+
+/**
+ * @brief Avanza il generatore di 2^128 numeri
+ * @param rng Il generatore
+*/
+static void rng_jump(Rng* rng);
+
+/**
+ * @brief Costruisce la tabella alias per i pesi forniti
+ * @param sampler La tabella da costruire
+ * @param weights Il peso di ogni tipo di tessera; almeno un peso deve essere positivo
+*/
+static void sampler_init(KindSampler* sampler, uint32_t const weights[TILE_KINDS]);
+
+/**
+ * @brief Estrae un tipo di tessera
+ * @param sampler La tabella alias
+ * @param rng Il generatore
+ * @return Il tipo estratto
+*/
+static int sample_kind(KindSampler const* sampler, Rng* rng);
+
+
+
+//Funzioni per la gestione delle regole di gioco
+
+/**
+ * @brief Funzione che genera una mano in modo riproducibile: lo stesso seme produce sempre la stessa mano
+ * @param seed seme della mano
+ * @param mix composizione della mano (MIX_PLAIN, MIX_UNIFORM o MIX_SPECIAL)
+ * @param tiles array di almeno n Tile in cui viene scritta la mano
+ * @param n numero di tessere
+*/
+static void generate_seeded_hand(uint64_t seed, int mix, Tile* tiles, int n);
+
+/**
+ * @brief Funzione che indica se la tessera è la speciale [0|0], compatibile con qualsiasi valore
+ * @param el tessera da controllare
+ * @return true se la tessera è [0|0], false altrimenti
+*/
+static bool is_any(Tile el);
+
+/**
+ * @brief Funzione che indica se la tessera è la speciale [11|11], che incrementa di 1 tutto il campo
+ * @param el tessera da controllare
+ * @return true se la tessera è [11|11], false altrimenti
+*/
+static bool is_sum(Tile el);
+
+/**
+ * @brief Funzione che indica se la tessera è la speciale [12|21], che copia invertita la tessera adiacente
+ * @param el tessera da controllare
+ * @return true se la tessera è [12|21], false altrimenti
+*/
+static bool is_mirror(Tile el);
+
+
+/**
+ * @brief Funzione che permette di spostare una tessera dalla propria mano nel campo di gioco
+ * @param field campo di gioco, dove verrà inserita la tessera
+ * @param hand mano del giocatore, da dove verrà eliminata la tessera
+ * @param el tessera da spostare
+ * @return true se la tessera è stata spostata, false se non è in mano o la mossa non è valida
+*/
+static bool move_tile(Field* field, Hand* hand, char pos, Tile el);
+
+/**
+ * @brief Funzione che sposta una tessera del tipo fornito dalla mano al campo, registrando in u come annullare la mossa.
+ * Le tessere normali vengono girate in modo che la metà compatibile sia adiacente al campo; se l'estremo del campo è uno [0|0]
+ * la tessera mantiene il suo verso, eventualmente invertito da flip
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param kind tipo della tessera da spostare
+ * @param pos lato del campo in cui inserire la tessera
+ * @param flip true se la tessera va inserita invertita
+ * @param u Undo in cui vengono registrate le modifiche effettuate
+*/
+static void make_move(Field* field, Hand* hand, int kind, char pos, bool flip, Undo* u);
+
+/**
+ * @brief Funzione che annulla la mossa registrata in u, riportando campo e mano allo stato precedente
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param u Undo registrato da make_move
+*/
+static void unmake_move(Field* field, Hand* hand, Undo const* u);
+
+/**
+ * @brief Funzione che valuta se la mossa effettuata dal giocatore è valida o meno
+ * @param field campo di gioco
+ * @param pos mossa effettuata dal giocatore
+ * @param el tessera mossa dal giocatore
+ * @return true se la mossa è valida, false altrimenti
+*/
+static bool valid_move(Field const* field, char pos, Tile el);
+
+/**
+ * @brief Funzione che valuta se esistono mosse valide effettuabili dal giocatore può effettuare ancora mosse valide
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @return true se esistono mosse valide, false altrimenti
+*/
+static bool possible_moves(Field const* field, Hand const* hand);
+
+/**
+ * @brief Funzione che restituisce la bitmask dei tipi di tessera in mano che possono essere inseriti nel lato pos del campo
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param pos lato del campo ('S' per la prima mossa)
+ * @return La bitmask dei tipi giocabili
+*/
+static uint64_t playable_kinds(Field const* field, Hand const* hand, char pos);
+
+/**
+ * @brief Funzione che elenca le mosse possibili dallo stato attuale, nell'ordine usato dalla ricerca:
+ * prima il lato destro poi il sinistro, i tipi di tessera in ordine crescente e per ogni tipo prima il verso originale.
+ * Le mosse equivalenti per simmetria vengono elencate una sola volta: [b|a] è omessa se nella mano c'è anche [a|b],
+ * e se il campo è simmetrico si elencano solo le mosse a destra
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param moves array di almeno MAX_MOVES elementi in cui vengono scritte le mosse
+ * @return Il numero di mosse
+*/
+static int list_moves(Field const* field, Hand const* hand, Move* moves);
+
+/**
+ * @brief Funzione che calcola i punti guadagnati dall'ultima mossa, dopo che è stata applicata con make_move
+ * @param field campo di gioco
+ * @param u Undo registrato da make_move
+ * @return I punti guadagnati con la mossa
+*/
+static int move_gain(Field const* field, Undo const* u);
+
+/**
+ * @brief Funzione che calcola i punti che una tessera speciale guadagnerebbe nel lato pos del campo, senza applicare la mossa
+ * @param field campo di gioco
+ * @param kind tipo della tessera speciale
+ * @param pos lato del campo
+ * @return I punti che verrebbero guadagnati con la mossa
+*/
+static int special_gain(Field const* field, int kind, char pos);
+
+/**
+ * @brief Funzione che trova, tra i tipi di tessera normali della bitmask, quello di valore massimo con l'indice più basso.
+ * Con SSE2 o AVX2 la bitmask viene espansa in byte e confrontata con la tabella dei valori in pochi vettori,
+ * altrimenti i tipi vengono scanditi uno ad uno
+ * @param kinds bitmask non vuota di tipi di tessera normali
+ * @return Il tipo scelto
+*/
+static int max_pips_kind(uint64_t kinds);
+
+/**
+ * @brief Funzione che sceglie la mossa che guadagna più punti, a parità la prima nell'ordine di list_moves,
+ * calcolando i punti di ogni candidata senza applicarla
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param move Move in cui viene scritta la mossa scelta
+ * @return I punti guadagnati dalla mossa, -1 se non esistono mosse possibili
+*/
+static int greedy_move(Field const* field, Hand const* hand, Move* move);
+
+
+/**
+ * @brief Funzione che calcola la somma dei valori delle tessere normali in mano che potranno ancora essere giocate.
+ * Senza [11|11] e [0|0] in mano e senza estremi [0|0] nel campo, una tessera può essere giocata solo se è collegata,
+ * attraverso le altre tessere in mano, ad un valore raggiungibile agli estremi del campo
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @return La somma dei valori delle tessere normali giocabili
+*/
+static int reachable_pips(Field const* field, Hand const* hand);
+
+/**
+ * @brief Funzione che calcola un limite superiore ammissibile al punteggio aggiuntivo ottenibile dallo stato attuale.
+ * Ogni [12|21] vale al più il doppio del massimo valore raggiungibile da una metà di tessera, e la j-esima [11|11]
+ * vale al più 2 punti per ogni tessera che può precedere nel campo più la copia della tessera adiacente
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @return Il limite superiore
+*/
+static int upper_bound(Field const* field, Hand const* hand);
+
+/**
+ * @brief Funzione che aggiorna il miglior punteggio totale condiviso, se total è maggiore
+ * @param s stato della ricerca
+ * @param total punteggio totale ottenibile
+*/
+static void update_best(Search* s, int total);
+
+/**
+ * @brief Funzione che registra le mosse in s->path come miglior partita completa se il suo punteggio è maggiore
+ * @param s stato della ricerca
+ * @param total punteggio totale della partita
+*/
+static void record_line(Search* s, int total);
+
+/**
+ * @brief Funzione che calcola il massimo punteggio aggiuntivo ottenibile con una mano senza tessere speciali.
+ * Le tessere sono gli archi di un multigrafo sui valori 1-6 e il campo un arco virtuale tra i suoi estremi: le mosse
+ * possibili formano una scia che contiene l'arco virtuale, e il punteggio è il peso della scia. Per ogni tipo di arco
+ * basta provare ad usarne tutte le copie o tutte meno una, scegliendo la componente dell'arco virtuale con al più
+ * due vertici dispari; la scia viene poi costruita con l'algoritmo di Hierholzer
+ * @param field campo di gioco, non vuoto
+ * @param hand mano del giocatore, senza tessere speciali
+ * @param scratch memoria per la costruzione della scia, almeno 2*(hand->size+3) elementi (ignorata se moves è NULL)
+ * @param moves array in cui vengono scritte le mosse della scia ottima (NULL se vanno calcolati solo i punti)
+ * @param n_moves puntatore in cui viene scritto il numero di mosse (ignorato se moves è NULL)
+ * @return Il punteggio aggiuntivo massimo
+*/
+static int trail_value(Field const* field, Hand const* hand, uint8_t* scratch, Move* moves, int* n_moves);
+
+/**
+ * @brief Funzione che valuta una posizione per il motore a fascio: il punteggio attuale più una stima di quello ancora
+ * ottenibile. Senza tessere speciali in mano la stima è esatta (trail_value), altrimenti conta i valori raggiungibili,
+ * il guadagno atteso delle tessere speciali e quanti tipi di tessera possono essere accostati agli estremi
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @return La valutazione
+*/
+static int beam_eval(Field const* field, Hand const* hand);
+
+/**
+ * @brief Funzione che cerca una partita con una ricerca a fascio: ad ogni mossa vengono tenute solo le width posizioni
+ * con la valutazione migliore, scartando quelle già raggiunte con mosse in ordine diverso. Il risultato non è dimostrato
+ * ottimo, ma il tempo cresce solo linearmente con il numero di tessere
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param width numero di posizioni tenute ad ogni mossa
+ * @param result Result in cui viene scritta la partita trovata
+ * @return true se è stata trovata una partita, false se la memoria non basta neanche per una posizione per mossa
+*/
+static bool beam_search(Field* field, Hand* hand, int width, Result* result);
+
+/**
+ * @brief Funzione che completa la partita scegliendo ad ogni turno la mossa che guadagna più punti, registrandola
+ * con record_line, e riporta campo e mano allo stato iniziale
+ * @param s stato della ricerca
+ * @return Il punteggio aggiuntivo della partita completata
+*/
+static int greedy_rollout(Search* s);
+
+/**
+ * @brief Funzione che restituisce l'istante attuale in microsecondi, da un orologio monotono
+ * @return L'istante attuale
+*/
+static long long monotonic_us(void);
+
+/**
+ * @brief Funzione che restituisce l'istante attuale in millisecondi, da un orologio monotono
+ * @return L'istante attuale
+*/
+static long long monotonic_ms(void);
+
+/**
+ * @brief Funzione che aggiorna il conteggio delle posizioni del budget e dell'avanzamento e controlla se il budget è esaurito
+ * @param s stato della ricerca
+ * @return true se la ricerca va interrotta
+*/
+static bool out_of_budget(Search* s);
+
+#ifdef DOMINO_STATS
+/**
+ * @brief Azzera i contatori
+ * @param st I contatori
+ * @param interval_ms Intervallo tra due istantanee in millisecondi (0 se non vanno stampate)
+ * @param out File su cui scrivere le istantanee (NULL se non vanno stampate)
+*/
+static void stats_init(Stats* st, long interval_ms, FILE* out);
+
+/**
+ * @brief Somma i contatori di src a quelli di dest, tempi delle mosse dalla radice esclusi
+ * @param dest I contatori da aggiornare
+ * @param src I contatori da sommare
+*/
+static void stats_merge(Stats* dest, Stats const* src);
+
+/**
+ * @brief Stampa su stderr un'istantanea dei contatori se è passato l'intervallo previsto; il tempo viene letto
+ * solo ogni BUDGET_CHECK posizioni
+ * @param s stato della ricerca
+*/
+static void stats_tick(Search* s);
+
+/**
+ * @brief Scrive i contatori come blocco di righe "nome valore", tra "#stats" e "#end"
+ * @param out file su cui scrivere
+ * @param st I contatori
+ * @param nodes Posizioni espanse
+ * @param cutoffs Rami scartati
+*/
+static void print_stats(FILE* out, Stats const* st, uint64_t nodes, uint64_t cutoffs);
+#endif
+
+/**
+ * @brief Funzione che applica la prima mossa che permette di realizzare ancora target punti aggiuntivi
+ * @param s stato della ricerca
+ * @param target punteggio aggiuntivo ancora da realizzare, ridotto dei punti guadagnati con la mossa
+ * @param move Move in cui viene scritta la mossa applicata
+ * @param u Undo in cui viene registrata la mossa applicata
+ * @return true se è stata applicata una mossa, false se non esistono mosse possibili
+*/
+static bool best_move(Search* s, int* target, Move* move, Undo* u);
+
+/**
+ * @brief Funzione che esplora tutte le mosse dalla radice, in parallelo se threads è maggiore di 1
+ * @param s stato della ricerca
+ * @param threads numero di thread
+*/
+static void search_root(Search* s, int threads);
+
+/**
+ * @brief Funzione che restituisce la tessera giocata da una mossa, nel verso in cui viene inserita
+ * @param m La mossa
+ * @return La tessera orientata
+*/
+static Tile move_oriented(Move const* m);
+
+/**
+ * @brief Funzione che esegue la ricerca ad approfondimento iterativo: ogni iterazione raddoppia il numero di mosse
+ * esplorate prima di completare la partita con mosse greedy, finché una ricerca non è esatta o il budget non è esaurito.
+ * La tabella delle trasposizioni è condivisa tra le iterazioni, perché i limiti memorizzati restano validi
+ * @param s stato della ricerca, con budget e line impostati
+ * @param threads numero di thread
+ * @return true se il punteggio trovato è dimostrato ottimo
+*/
+static bool anytime_search(Search* s, int threads);
+
+/**
+ * @brief Funzione che prepara lo stato di una ricerca esatta dalla posizione attuale, senza budget, partita registrata
+ * né avanzamento. path e trail vengono presi dall'Arena del campo (o con malloc se non ne ha uno) e vanno liberati con
+ * search_free
+ * @param s Search da inizializzare
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param opt opzioni della ricerca, da cui vengono presi motore e tablebase
+ * @param tt tabella delle trasposizioni
+ * @param best miglior punteggio totale, condiviso tra i thread
+ * @param stats_interval intervallo in millisecondi delle istantanee dei contatori (0 per nessuna)
+ * @return true se path e trail sono stati allocati, false se la memoria non basta; search_free va chiamata in entrambi i
+ * casi
+*/
+static bool search_init(Search* s, Field* field, Hand* hand, Options const* opt, TTable* tt, atomic_int* best, long stats_interval);
+
+/**
+ * @brief Funzione che libera la memoria presa da search_init
+ * @param s stato della ricerca
+*/
+static void search_free(Search* s);
+
+/**
+ * @brief Funzione che ricostruisce, dopo una ricerca esatta, la partita che realizza best, lasciando campo e mano invariati
+ * @param s stato della ricerca terminata
+ * @param best punteggio totale dimostrato ottimo
+ * @param pv array di almeno hand->size mosse in cui viene scritta la partita
+ * @param played array di almeno hand->size Undo usato per rigiocare la partita
+ * @return Il numero di mosse della partita
+*/
+static int extract_pv(Search* s, int best, Move* pv, Undo* played);
+
+/**
+ * @brief Funzione che copia il campo di gioco fornito
+ * @param field Il campo da copiare
+ * @return Il nuovo campo allocato, con la stessa capacità riservata, NULL se la memoria non basta
+*/
+static Field* clone_field(Field const* field);
+
+/**
+ * @brief Funzione che copia il campo di gioco src in dest, riusandone il buffer
+ * @param src Il campo da copiare
+ * @param dest Il campo in cui copiarlo
+ * @return true se la copia è riuscita, false se la memoria non basta per ingrandire dest
+*/
+static bool copy_field(Field const* src, Field* dest);
+
+/**
+ * @brief Funzione che esplora tutte le mosse dalla posizione attuale di s dividendo il lavoro tra più thread.
+ * Ogni thread lavora su una propria copia del campo e della mano e condivide con gli altri la tabella delle trasposizioni
+ * e il miglior punteggio trovato; i Task vicini alla radice vengono divisi nei loro figli quando ci sono thread senza lavoro
+ * @param s stato della ricerca, i cui contatori vengono incrementati con quelli dei thread
+ * @param threads numero di thread
+ * @return true se la ricerca è stata eseguita, false se la memoria non basta per i thread e non è stato esplorato nulla
+*/
+static bool parallel_search(Search* s, int threads);
+
+/**
+ * @brief Funzione che calcola il massimo punteggio realizzabile senza stampare nulla, lasciando campo e mano invariati.
+ * La tabella delle trasposizioni può essere riusata tra mani diverse, perché la chiave descrive tutta la posizione.
+ * Se il campo usa un Arena, anche la memoria temporanea della risoluzione viene presa da lì e rilasciata alla fine
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param opt opzioni della ricerca, con il file su cui mostrare l'avanzamento
+ * @param tt tabella delle trasposizioni
+ * @param result Result in cui viene scritto il risultato; result->line va liberato con move_stack_free
+ * @return true se la mano è stata risolta, false se la memoria non basta e result non è stato scritto
+*/
+static bool solve(Field* field, Hand* hand, Options const* opt, TTable* tt, Result* result);
+
+/**
+ * @brief Funzione che calcola l'impronta canonica di una mano: il numero di tessere per tipo, con [a|b] e [b|a]
+ * contate insieme, così che la stessa mano letta in qualsiasi ordine e verso abbia la stessa impronta
+ * @param hand mano del giocatore
+ * @param count array in cui viene scritto il numero di tessere per tipo canonico
+ * @return La chiave hash dell'impronta
+*/
+static uint64_t hand_fingerprint(Hand const* hand, uint16_t count[TILE_KINDS]);
+
+/**
+ * @brief Funzione che apre la cache persistente dei risultati, creando il file se non esiste, e indicizza i record
+ * validi. Un file che non è una cache non viene mai sovrascritto
+ * @param cache Cache da inizializzare
+ * @param path percorso del file
+ * @param max_mb dimensione massima in MB del file
+ * @return DOMINO_OK, DOMINO_ERR_NO_MEMORY, DOMINO_ERR_IO se il file di lock non può essere aperto o DOMINO_ERR_BAD_FILE
+ * se il file non è una cache
+*/
+static int cache_open(Cache* cache, char const* path, size_t max_mb);
+
+/**
+ * @brief Funzione che chiude la cache e libera la memoria
+ * @param cache Cache da chiudere
+*/
+static void cache_close(Cache* cache);
+
+/**
+ * @brief Funzione che cerca il risultato di una mano nella cache. Le mosse salvate vengono rigiocate sul campo per
+ * controllarle e per ricostruire la partita, poi campo e mano tornano come prima
+ * @param cache Cache in cui cercare
+ * @param field campo di gioco, che deve essere vuoto
+ * @param hand mano del giocatore
+ * @param result Result in cui viene scritto il risultato se presente; result->line va liberato con move_stack_free
+ * @return true se la mano è nella cache, false se non c'è o se la memoria non basta per rigiocarla
+*/
+static bool cache_lookup(Cache* cache, Field* field, Hand* hand, Result* result);
+
+/**
+ * @brief Funzione che aggiunge in coda al file il risultato ottimo di una mano. Se il file supererebbe la dimensione
+ * massima, viene riscritto tenendo i record usati più di recente fino a metà della dimensione massima.
+ * Se la memoria non basta il risultato non viene salvato
+ * @param cache Cache in cui salvare
+ * @param hand mano del giocatore all'inizio della partita
+ * @param result risultato dimostrato ottimo della mano
+*/
+static void cache_store(Cache* cache, Hand const* hand, Result const* result);
+
+/**
+ * @brief Funzione che risolve una mano passando prima dalla cache di opt, se attiva. Solo i risultati dimostrati ottimi
+ * a partire dal campo vuoto vengono salvati
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param opt opzioni della ricerca
+ * @param tt tabella delle trasposizioni
+ * @param result Result in cui viene scritto il risultato; result->line va liberato con move_stack_free
+ * @param hit puntatore in cui viene scritto true se il risultato è stato letto dalla cache
+ * @return true se la mano è stata risolta, false se la memoria non basta e result non è stato scritto
+*/
+static bool cached_solve(Field* field, Hand* hand, Options const* opt, TTable* tt, Result* result, bool* hit);
+
+/**
+ * @brief Funzione che inizializza i coefficienti binomiali e la disposizione delle mani di una tablebase
+ * @param tb Tablebase
+ * @param tiles numero massimo di tessere in mano coperte
+*/
+static void tablebase_init(Tablebase* tb, int tiles);
+
+/**
+ * @brief Funzione che calcola il rango di una mano tra tutte le mani con lo stesso numero di tessere,
+ * contando insieme [a|b] e [b|a]
+ * @param tb Tablebase
+ * @param hand mano del giocatore, con al più TABLEBASE_MAX_TILES tessere
+ * @return Il rango della mano
+*/
+static size_t tablebase_rank(Tablebase const* tb, Hand const* hand);
+
+/**
+ * @brief Funzione che restituisce la posizione in tb->values dei punteggi di una mano
+ * @param tb Tablebase
+ * @param m numero di tessere della mano
+ * @param rank rango della mano
+ * @return La posizione del primo punteggio della mano
+*/
+static size_t tablebase_block(Tablebase const* tb, int m, size_t rank);
+
+/**
+ * @brief Funzione che legge dalla tablebase il punteggio ottimo ancora realizzabile nella posizione
+ * @param tb Tablebase
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param value puntatore in cui viene scritto il punteggio
+ * @return true se la posizione è coperta dalla tablebase
+*/
+static bool tablebase_probe(Tablebase const* tb, Field const* field, Hand const* hand, int* value);
+
+/**
+ * @brief Funzione che mappa in memoria il file di una tablebase
+ * @param tb Tablebase da inizializzare
+ * @param path percorso del file
+ * @return DOMINO_OK, DOMINO_ERR_IO se il file non può essere aperto o DOMINO_ERR_BAD_FILE se non è una tablebase
+ * o è troncato
+*/
+static int tablebase_load(Tablebase* tb, char const* path);
+
+/**
+ * @brief Funzione che rilascia la memoria di una tablebase
+ * @param tb Tablebase
+*/
+static void tablebase_free(Tablebase* tb);
+
+/**
+ * @brief Funzione eseguita da ogni thread della generazione della tablebase: risolve gruppi di mani finché ce ne sono
+ * @param arg puntatore al TablebaseJob
+ * @return NULL
+*/
+static void* tablebase_worker(void* arg);
+
+/**
+ * @brief Funzione che genera la tablebase per mani di al più tiles tessere e la scrive in path. Le mani vengono
+ * risolte per numero di tessere crescente, così che le posizioni successive ad ogni mossa si leggano da quanto già calcolato
+ * @param path file da scrivere
+ * @param tiles numero massimo di tessere in mano
+ * @param threads numero di thread
+ * @param log file su cui scrivere il tempo di ogni numero di tessere (NULL per non scriverlo)
+ * @return DOMINO_OK, DOMINO_ERR_INVALID_ARGUMENT se tiles supera TABLEBASE_MAX_TILES, DOMINO_ERR_NO_MEMORY o DOMINO_ERR_IO
+*/
+static int tablebase_generate(char const* path, int tiles, int threads, FILE* log);
+
+/**
+ * @brief Funzione che avvia la ricerca dei suggerimenti sulla posizione fornita
+ * @param e HintEngine da inizializzare
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param opt opzioni della ricerca
+ * @return true se la ricerca è stata avviata, false se la memoria non basta e e non va fermato con hint_stop
+*/
+static bool hint_start(HintEngine* e, Field const* field, Hand const* hand, Options const* opt);
+
+/**
+ * @brief Funzione che interrompe l'analisi in corso e passa alla nuova posizione. Se il giocatore ha giocato la prima
+ * mossa della miglior partita trovata, il resto della partita resta il suggerimento finché la ricerca non ne trova uno migliore
+ * @param e HintEngine avviato con hint_start
+ * @param field campo di gioco dopo la mossa del giocatore
+ * @param hand mano del giocatore dopo la mossa
+*/
+static void hint_update(HintEngine* e, Field const* field, Hand const* hand);
+
+/**
+ * @brief Funzione che ferma la ricerca dei suggerimenti e ne libera la memoria
+ * @param e HintEngine avviato con hint_start
+*/
+static void hint_stop(HintEngine* e);
+
+/**
+ * @brief Funzione che legge la miglior mossa trovata finora dalla posizione attuale
+ * @param e HintEngine avviato con hint_start
+ * @param move Move in cui viene scritta la mossa
+ * @param total intero in cui viene scritto il punteggio totale della partita che la segue
+ * @param proven bool in cui viene scritto true se la partita è dimostrata ottima
+ * @return true se è già stata trovata una partita
+*/
+static bool hint_get(HintEngine* e, Move* move, int* total, bool* proven);
+
+/**
+ * @brief Funzione che analizza la posizione di e con la ricerca ad approfondimento iterativo finché non dimostra
+ * la miglior partita o non viene interrotta, e in quel caso scrive in e->line la partita ottima
+ * @param e HintEngine
+*/
+static void hint_analyse(HintEngine* e);
+
+/**
+ * @brief Funzione eseguita dal thread dei suggerimenti: analizza ogni nuova posizione ricevuta
+ * @param arg HintEngine
+ * @return NULL
+*/
+static void* hint_worker(void* arg);
+
+/**
+ * @brief Funzione che calcola il punteggio totale del campo fornito
+ * @param field campo di gioco
+ * @return Il punteggio del campo, mantenuto aggiornato ad ogni mossa
+*/
+static int points(Field const* field);
+
+/**
+ * @brief Funzione che avvia il thread che mostra l'avanzamento di una ricerca. Su un terminale la riga viene riscritta
+ * ogni PROGRESS_TTY_MS millisecondi, altrimenti viene aggiunta una riga di log ogni PROGRESS_LOG_MS millisecondi
+ * @param p Progress da inizializzare
+ * @param best miglior punteggio totale condiviso dalla ricerca
+ * @param budget budget della ricerca (NULL se illimitato)
+ * @param out file su cui stampare l'avanzamento
+*/
+static void progress_start(Progress* p, atomic_int* best, Budget const* budget, FILE* out);
+
+/**
+ * @brief Funzione che ferma il thread dell'avanzamento e cancella la riga dal terminale
+ * @param p Progress avviato con progress_start
+*/
+static void progress_stop(Progress* p);
+
+/**
+ * @brief Funzione che stampa una riga con posizioni espanse, posizioni al secondo, stima del completamento e miglior punteggio
+ * @param p Progress da stampare
+*/
+static void progress_report(Progress* p);
+
+/**
+ * @brief Funzione eseguita dal thread dell'avanzamento
+ * @param arg Progress da stampare
+ * @return NULL
+*/
+static void* progress_worker(void* arg);
+
+/**
+ * @brief Funzione che scrive in opt le opzioni predefinite
+ * @param opt Options da inizializzare
+*/
+static void options_init(Options* opt);
+
+/**
+ * @brief Funzione che legge una mano dalle tessere passate alla libreria
+ * @param hand Hand in cui viene scritta la mano
+ * @param tiles tessere
+ * @param n numero di tessere
+ * @return true se tutte le tessere esistono e la mano rispetta HAND_KIND_MAX e HAND_SUM_MAX, false altrimenti
+*/
+static bool read_hand(Hand* hand, DominoTile const* tiles, int n);
+
+#endif
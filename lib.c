@@ -1,15 +1,23 @@
 /**
  * @file lib.c
  * @author FafNir
- * @brief Libreria che implementa il gioco Domino lineare
+ * @brief Tipi e prototipi del programma "Domino Lineare", che usa il motore solo attraverso l'interfaccia di "domino.h"
  * @date 26/01/2024
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include<stdio.h>
 #include<stdlib.h>
+#include<stddef.h>
 #include<string.h>
 #include<time.h>
 #include<stdbool.h>
+#include<stdint.h>
+#include<limits.h>
+#include<stdatomic.h>
+#include<pthread.h>
+#include "domino.h"
 
 /// @brief Costante per la selezione della modalità interattiva
 #define INTERACTIVE_MODE '1'
@@ -17,209 +25,173 @@
 #define AI_MODE '2'
 /// @brief Costante per la dimensione della mano del giocatore quando viene generata in modo random
 #define HAND_SIZE 100
+/// @brief Numero di mani lette e risolte insieme dalla modalità batch per ogni thread
+#define BATCH_CHUNK 64
+/// @brief Dimensione massima predefinita in MB del file della cache dei risultati
+#define CACHE_DEFAULT_MB 64
+/// @brief Numero predefinito di tessere in mano coperte dalla tablebase generata
+#define TABLEBASE_DEFAULT_TILES 4
 
 /**
- * @struct Tile
- * @brief Definisce il tipo Tile: rappresenta una singola tessera di gioco
+ * @struct Options
+ * @brief Definisce il tipo Options: le opzioni passate da riga di comando
 */
 typedef struct {
-  /** Valore sinistro della tessera */
-  int left; 
-  /** Valore destro della tessera */
-  int right;
-} Tile;
-
-/**
- * @struct vector
- * @brief Definisce il tipo vector: array dinamico usato per memorizzare un insieme di Tile, per descrivere la mano del giocatore e il campo di gioco
+  /** Opzioni dei contesti del risolutore: motore, thread, memoria, budget, cache e tablebase */
+  DominoOptions solver;
+  /** File da cui leggere le mani della modalità batch ("-" per stdin, NULL se la modalità batch non è attiva) */
+  char const* batch;
+  /** Seme dei contesti del risolutore: della mano casuale e, un flusso per thread, della modalità batch */
+  uint64_t seed;
+  /** true se il seme è stato indicato da riga di comando */
+  bool seeded;
+  /** true se le statistiche della ricerca vanno stampate su stderr */
+  bool stats;
+  /** true se l'avanzamento della modalità AI va mostrato */
+  bool progress;
+  /** true se la modalità interattiva deve calcolare suggerimenti in background */
+  bool hints;
+  /** File della cache persistente dei risultati (NULL se la cache non è attiva) */
+  char const* cache;
+  /** Dimensione massima in MB del file della cache */
+  size_t cache_mb;
+  /** File della tablebase da consultare (NULL se non attiva) */
+  char const* tablebase;
+  /** File in cui generare la tablebase (NULL se la generazione non è richiesta) */
+  char const* tablebase_gen;
+  /** Numero di tessere in mano coperte dalla tablebase generata */
+  int tablebase_tiles;
+} Options;
+
+/**
+ * @struct BatchJob
+ * @brief Definisce il tipo BatchJob: una mano letta dalla modalità batch e il suo risultato
 */
 typedef struct {
-  /** Dimensione attuale del vector */
-  size_t size;
-  /** Capacità totale del vector */ 
-  size_t capacity;
-  /** Array di Tile */ 
-  Tile* data;
-} vector;
+  /** Riga letta, con le tessere come coppie di interi separati da spazi */
+  char* line;
+  /** DOMINO_OK se la mano è stata risolta, altrimenti il codice di errore */
+  int status;
+  /** Risultato della ricerca */
+  DominoResult result;
+  /** Tempo della ricerca in millisecondi */
+  double time_ms;
+} BatchJob;
 
 /**
- * @struct m_vector
- * @brief Definisce il tipo m_vector: array dinamico usato per memorizzare le mosse compiute AI
+ * @struct Batch
+ * @brief Definisce il tipo Batch: un gruppo di mani risolte in parallelo dalla modalità batch
 */
 typedef struct {
-  /** Dimensione attuale del m_vector */
-  size_t size; 
-  /** Capacità totale del m_vector */
-  size_t capacity;
-  /** Array di caratteri */ 
-  char* data; 
-} m_vector;
-
-// Funzioni per la gestione di vector
-
-/**
- * @brief Funzione per l'allocazione di un nuovo array dinamico di Tiles
- * @return Il nuovo array dinamico allocato
-*/
-vector* create_vector();
-
-
-/**
- * @brief Funzione per la deallocazione del vector passato
- * @param v Il vector da deallocare
-*/
-void free_vector(vector* v);
-
-/**
- * @brief Modifica la capacità del vector fornito
- * @param v Il vector di cui si vuole modificare la capacità
- * @param new_capacity La nuova capacità del vector
-*/
-void resize(vector* v, size_t new_capacity);
-
-/**
- * @brief Inserisce un elemento in coda al vector v
- * @param v Il vector da modificare
- * @param el L'elemento da inserire in coda a v
-*/
-void push_back(vector* v, Tile el);
-
-/**
- * @brief Inserisce un elemento in testa al vector v
- * @param v Il vector da modificare
- * @param el L'elemento da inserire in testa a v
-*/
-void push_front(vector* v, Tile el);
+  /** Array di mani */
+  BatchJob* jobs;
+  /** Numero di mani */
+  int count;
+  /** Indice della prossima mano da risolvere */
+  atomic_int next;
+} Batch;
 
 /**
- * @brief Elimina l'elemento del vector v all'indice fornito
- * @param v Il vector da modificare
- * @param index L'indice dell'elemento da eliminare
+ * @struct BatchWorker
+ * @brief Definisce il tipo BatchWorker: un thread della modalità batch, con il proprio contesto
 */
-void delete_at(vector* v, size_t index);
-
-/**
- * @brief Alloca un nuovo vector che è la copia di quello fornito
- * @param v Il vector di cui si vuole creare una copia
- * @return Il nuovo vector copia di v
-*/
-vector* clone(vector const* v);
-
-/**
- * @brief Copia gli elementi di src in dest sovrascrivendoli
- * @param src Vector di cui si vogliono copiare gli elementi
- * @param dest Vector in cui si vogliono copiare gli elemetni di src
-*/
-void copy_vector(vector const* src, vector* dest);
-
-// Funzioni per la gestione di m_vector
-
-/**
- * @brief Funzione per la creazione di un nuovo array dinamico di mosse
- * @return Il nuovo m_vector allocato
-*/
-m_vector* create_m_vector();
-
-/**
- * @brief Funzione per la deallocazione di un m_vector
- * @param v L' m_vector da deallocare
-*/
-void free_m_vector(m_vector* v);
-
-/**
- * @brief Modifica la capacità del m_vector fornito
- * @param v L' m_vector di cui si vuole modificare la capacità
- * @param new_capacity La nuova capacità dell' m_vector
-*/
-void resize_m_vector(m_vector* v, size_t new_capacity);
+typedef struct {
+  /** Gruppo di mani da risolvere */
+  Batch* batch;
+  /** Contesto del thread, riusato per tutte le mani */
+  DominoSolver* solver;
+} BatchWorker;
 
 /**
- * @brief Inserisce un elemento in coda al m_vector v
- * @param v L' m_vector da modificare
- * @param el Il Tile da inserire in coda
- * @param c Il carattere della mossa effettuata
+ * @brief Funzione che termina il programma se un'operazione della libreria non è riuscita, stampando la descrizione
+ * del codice restituito
+ * @param status codice restituito dalla libreria
 */
-void push_back_m_vector(m_vector* v, Tile el, char c);
+void check_status(int status);
 
 /**
- * @brief Copia gli elementi di src in dest sovrascrivendoli
- * @param src m_vector di cui si vogliono copiare gli elementi
- * @param dest m_vector in cui si vogliono copiare gli elemetni di src
+ * @brief Funzione che restituisce il tempo di un orologio monotono
+ * @return Il tempo in microsecondi
 */
-void copy_m_vector(m_vector const* src, m_vector* dest);
-
-//Funzioni per la gestione delle regole di gioco
+long long clock_us(void);
 
 /**
- * @brief Funzione che alloca un nuovo vector di Tile casuali
- * @return vector di Tile casuali
+ * @brief Funzione che calcola con il contesto fornito la miglior partita per la mano e la stampa, con il campo finale
+ * e le mosse. Se le opzioni fissano un tempo o un numero di posizioni massimo, allo scadere del budget viene stampata
+ * la miglior partita completa trovata indicando che non è dimostrata ottima
+ * @param solver contesto del risolutore
+ * @param tiles tessere della mano
+ * @param n numero di tessere
+ * @param opt opzioni
+ * @return Il punteggio massimo calcolato
 */
-vector* generate_random_hand();
+int recursive_mode(DominoSolver* solver, DominoTile const* tiles, int n, Options const* opt);
 
 /**
- * @brief Funzione che elimina la prima occorrenza (se esistono duplicati) della tessera el dal vector v, se presente
- * @param v vector in cui si vuole eliminare la tessera
- * @param el Tile da eliminare
- * @return true se la tessera è stata trovata ed eliminata, false altrimenti
+ * @brief Funzione che stampa il suggerimento attuale della partita
+ * @param game partita con i suggerimenti attivi
 */
-bool delete_tile(vector* v, Tile el);
+void print_hint(DominoGame* game);
 
 /**
- * @brief Funzione che permette di spostare una tessera dalla propria mano nel campo di gioco
- * @param field vector che rappresenta il campo di gioco, dove verrà inserita la tessera
- * @param hand vector che rappresenta la mano del giocatore, da dove verrà eliminata la tessera
- * @param el tessera da spostare
+ * @brief Funzione che stampa il campo di gioco e la mano
+ * @param game partita
+ * @param buffer array di almeno tante tessere quante ne aveva la mano all'inizio
 */
-void move_tile(vector* field, vector* hand, char pos, Tile el);
+void print_field(DominoGame const* game, DominoTile* buffer);
 
 /**
- * @brief Funzione che valuta se la mossa effettuata dal giocatore è valida o meno
- * @param field vector che rappresenta il campo di gioco
- * @param pos mossa effettuata dal giocatore
- * @param el tessera mossa dal giocatore
- * @return true se la mossa è valida, false altrimenti
+ * @brief Funzione che scrive le mosse fornite su un file, come terne "lato sinistro destro" separate da spazi.
+ * Ogni tessera è scritta nel verso in cui va inserita, cioè come va digitata nella modalità interattiva
+ * @param out file su cui scrivere
+ * @param result risultato con le mosse
 */
-bool valid_move(vector const* field, char pos, Tile el);
+void write_moves(FILE* out, DominoResult const* result);
 
 /**
- * @brief Funzione che valuta se esistono mosse valide effettuabili dal giocatore può effettuare ancora mosse valide
- * @param field vector che rappresenta il campo di gioco
- * @param hand vector che rappresenta la mano del giocatore
- * @return true se esistono mosse valide, false altrimenti
+ * @brief Funzione che stampa le mosse della partita trovata
+ * @param result risultato con le mosse
 */
-bool possible_moves(vector const* field, vector const* hand);
+void print_moves(DominoResult const* result);
 
 /**
- * @brief Funzione che calcola ricorsivamente il massimo punteggio realizzabile 
- * @param field vector che rappresenta il campo di gioco
- * @param hand vector che rappresenta la mano del giocatore
- * @return Il punteggio massimo calcolato
+ * @brief Funzione che legge una mano da una riga della modalità batch
+ * @param line riga con le tessere come coppie di interi separati da spazi
+ * @param tiles array di almeno strlen(line)/4 + 1 tessere in cui viene scritta la mano
+ * @param n puntatore in cui viene scritto il numero di tessere
+ * @return true se la riga contiene solo coppie di interi, false altrimenti
 */
-int recursive_mode(vector* field, vector* hand);
+bool parse_hand_line(char const* line, DominoTile* tiles, int* n);
 
 /**
- * @brief Funzione che calcola il punteggio totale del vector fornito
- * @param v vector di cui si vuole calcolare il punteggio
- * @return Il punteggio del vector
+ * @brief Funzione eseguita dai thread della modalità batch: risolve le mani del Batch con il proprio contesto
+ * finché non sono finite
+ * @param arg Il BatchWorker del thread
+ * @return NULL
 */
-int points(vector const* v);
+void* batch_worker(void* arg);
 
 /**
- * @brief Funzione che stampa il campo di gioco
- * @param field vector che rappresenta il campo di gioco
- * @param hand vector che rappresenta la mano del giocatore
+ * @brief Funzione della modalità batch: legge una mano per riga dal file indicato in opt->batch e scrive su stdout
+ * una riga per mano, nello stesso ordine, con i campi separati da tabulazioni: punteggio, 1 se dimostrato ottimo
+ * e 0 altrimenti, posizioni espanse, tempo in millisecondi e mosse. Le righe non valide producono "error".
+ * Le mani vengono lette BATCH_CHUNK per thread alla volta, quindi la memoria usata non dipende dalla dimensione del file.
+ * Ogni thread ha il proprio contesto, con una parte della memoria della tabella delle trasposizioni e il proprio flusso
+ * del generatore casuale
+ * @param opt opzioni, in cui solver.threads indica il numero di mani risolte in parallelo
 */
-void print_field(vector const* field, vector const* hand);
+void batch_mode(Options const* opt);
 
 /**
- * @brief Funzione che stampa le mosse effettuate dal giocatore
- * @param moves m_vector che rappresenta le mosse effettuate 
+ * @brief Funzione che scrive in opt le opzioni predefinite
+ * @param opt Options da inizializzare
 */
-void print_moves(m_vector const* moves);
+void options_init(Options* opt);
 
 /**
- * @brief Funzione che stampa la barra di caricamento
- * @param p Valore che rappresenta lo step di iterazione a cui si è arrivati
- * @param width Valore che rappresenta il numero totale di iterazioni
+ * @brief Funzione che legge le opzioni da riga di comando
+ * @param argc Numero di argomenti
+ * @param argv Argomenti passati al programma
+ * @param opt Options in cui vengono scritte le opzioni lette
 */
-void progress_bar(int p, int width);
+void parse_options(int argc, char** argv, Options* opt);
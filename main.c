@@ -1,550 +1,539 @@
 /**
  * @file main.c
  * @author FafNir
- * @brief Codice che realizza il gioco "Domino Lineare"
+ * @brief Codice che realizza il gioco "Domino Lineare", come client della libreria libdomino
  * @date 26/01/2024
- * 
+ *
  * @section compilazione Compilazione
  * Per eseguire il programma bisogna:
- *  - compilare il file "main.c" eseguendo il comando "gcc -O2 -std=c99 --pedantic *.c -o main"
+ *  - compilare eseguendo il comando "make", oppure "gcc -O2 -std=c11 --pedantic -pthread *.c -o main"
  *  - eseguire il file generato dalla compilazione "main"
+ *
+ * "make" genera anche la libreria libdomino (libdomino.a e libdomino.so), la cui interfaccia è in "domino.h".
+ * Il benchmark della libreria è un programma a parte, in "tools/bench.c": si compila ed esegue con "make bench"
  */
 
 #include "lib.c"
 
 /*
-Funzioni per la gestione di vector
+Funzioni ausiliarie
 */
-vector* create_vector() {
-  vector* v = (vector*) malloc(sizeof(vector));
-  if(v == NULL) {
-    printf("[+]Error: Memory allocation failed. Exiting program");
-    exit(EXIT_FAILURE);
-  }
-
-  v->size = 0;
-  v->capacity = 4;
-  v->data = (Tile*)malloc(sizeof(Tile)*v->capacity);
-  if(v->data == NULL) {
-    printf("[+]Error: Memory allocation failed. Exiting program");
-    exit(EXIT_FAILURE);
-  }
-
-  return v;
-}
-
-void free_vector(vector* v) {
-  free(v->data);
-  free(v);
-}
-
-void resize(vector* v, size_t new_capacity) {
-  Tile* new_data = (Tile*)malloc(sizeof(Tile) * new_capacity);
-  if (new_data == NULL) {
-    printf("[+]Error: Memory allocation failed. Exiting program");
-    exit(EXIT_FAILURE);
-  }
-
-  for(size_t i=0; i < v->size; i++) {
-    new_data[i].left = v->data[i].left;
-    new_data[i].right = v->data[i].right;
-  }
-
-  free(v->data);
 
-  v->data = new_data;
-  v->capacity = new_capacity;
-}
-
-void push_back(vector* v, Tile el) {
-  if(v->size == v->capacity)
-    resize(v, v->size*2);
+void check_status(int status) {
+  if(status == DOMINO_OK) return;
 
-  v->data[v->size].left = el.left;
-  v->data[v->size].right = el.right;
-  v->size += 1;
+  printf("[+]Error: %s. Exiting program", domino_strerror(status));
+  exit(EXIT_FAILURE);
 }
 
-void push_front(vector* v, Tile el) {
-  if(v->size == v->capacity) {
-    resize(v, v->size*2);
-  }
-
-  for(size_t i=v->size; i > 0; i--) {
-    v->data[i] = v->data[i-1];
-  }
+long long clock_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
 
-  v->size += 1;
-  v->data[0] = el;
+  return (long long)ts.tv_sec*1000000 + ts.tv_nsec/1000;
 }
 
-void delete_at(vector* v, size_t index) {
-  if(index >= v->size) {
-    printf("[+]Error: index %lu is out of bounds", index);
-    exit(EXIT_FAILURE);
-  }
+/*
+Funzioni per la modalità AI
+*/
 
-  for(size_t i=index; i<v->size; i++) {
-    v->data[i] = v->data[i+1];
-  }
-  v->size -= 1;
+int recursive_mode(DominoSolver* solver, DominoTile const* tiles, int n, Options const* opt) {
+  DominoResult r;
+  DominoGame* game;
+  check_status(domino_solve(solver, tiles, n, &r));
+  check_status(domino_game_create(solver, tiles, n, &game));
 
-  if(v->size <= v->capacity/2) {
-    resize(v, v->capacity/2);
-  }
-}
+  //la partita trovata viene giocata sul campo per stamparlo
+  for(int i=0; i<r.n_moves; i++)
+    domino_game_play(game, r.moves[i].side, r.moves[i].tile);
 
-vector* clone(vector const* v) {
-  vector* c = (vector*) malloc(sizeof(vector));
-  if(c == NULL) {
+  DominoTile* buffer = (DominoTile*)malloc(sizeof(DominoTile) * (n > 0 ? n : 1));
+  if(buffer == NULL) {
     printf("[+]Error: Memory allocation failed. Exiting program");
     exit(EXIT_FAILURE);
   }
-  c->size = v->size;
-  c->capacity = v->capacity;
-  c->data = (Tile*) malloc(sizeof(Tile) * c->capacity);
-  if(c->data == NULL) {
-    printf("[+]Error: Memory allocation failed. Exiting program");
-    exit(EXIT_FAILURE);
-  }
-
-  memcpy(c->data, v->data, v->size*sizeof(Tile));
-
-  return c;
-}
-
-void copy_vector(vector const* src, vector* dest) {
-  if(dest->size < src->size) {
-    resize(dest, src->size);
-  }
 
-  dest->size = 0;
-  for(int i=0; i<src->size; i++) {
-    push_back(dest, src->data[i]);
-  }
+  print_field(game, buffer);
+  print_moves(&r);
+  printf("\nNodes: %llu Cut-offs: %llu", (unsigned long long)r.nodes, (unsigned long long)r.cutoffs);
+  if(opt->solver.time_ms > 0 || opt->solver.max_nodes > 0)
+    printf("\nOptimal: %s", r.proven ? "proven" : "not proven (budget exhausted)");
+  if(opt->solver.cache != NULL)
+    printf("\nCache: %s", r.cache_hit ? "hit" : "miss");
+  if(r.optimum >= 0)
+    printf("\nOptimum: %d (gap %d, %.2f%%)", r.optimum, r.optimum - r.total,
+           r.optimum > 0 ? 100.0 * (r.optimum - r.total) / r.optimum : 0.0);
+  if(opt->stats)
+    domino_result_print_stats(&r, stderr);
+
+  int total = r.total;
+  free(buffer);
+  domino_game_free(game);
+  domino_result_free(&r);
+
+  return total;
 }
 
-
 /*
-Funzioni per la gestione di m_vector
+Funzioni per la modalità interattiva
 */
 
-m_vector* create_m_vector() {
-  m_vector* v = (m_vector*)malloc(sizeof(m_vector));
-  if(v == NULL) {
-    printf("[+]Error: Memory allocation failed. Exiting program");
-    exit(EXIT_FAILURE);
-  }
-
-  v->size = 0;
-  v->capacity = 4;
-  v->data = (char*)malloc(v->capacity);
-  if(v->data == NULL) {
-    printf("[+]Error: Memory allocation failed. Exiting program");
-    exit(EXIT_FAILURE);
-  }
-
-  return v;
-}
-
-void free_m_vector(m_vector* v) {
-  free(v->data);
-  free(v);
-}
-
-void resize_m_vector(m_vector* v, size_t new_capacity) {
-  char* new_data = (char*)malloc(new_capacity);
-  if (new_data == NULL) {
-    printf("[+]Error: Memory allocation failed. Exiting program");
-    exit(EXIT_FAILURE);
-  }
-
-  for(int i=0; i<v->size; i++) {
-    new_data[i] = v->data[i];
-  }
+void print_hint(DominoGame* game) {
+  char side;
+  DominoTile el;
+  int total;
+  bool proven;
 
-  free(v->data);
-
-  v->data = new_data;
-  v->capacity = new_capacity;
+  if(!domino_game_hint(game, &side, &el, &total, &proven))
+    printf("Hint: still thinking\n");
+  else
+    printf("Hint: %c %d %d (%s %d)\n", side, el.left, el.right, proven ? "optimal total" : "best total so far", total);
 }
 
-/**
- * @brief Aggiunge un carattere in coda al vector fornito
- * @param v L' m_vector in cui inserire il carattere
- * @param c Il carattere da inserire in coda
+/*
+Funzioni per la modalità batch
 */
-void _push_back_m_vector(m_vector* v, char c) {
-  if(v->size == v->capacity)
-    resize_m_vector(v, v->size*2);
-
-  v->data[v->size] = c;
-  v->size += 1;
-}
-
-void push_back_m_vector(m_vector* v, Tile el, char c) {
-  _push_back_m_vector(v, c);
-  _push_back_m_vector(v, el.left + '0');
-  _push_back_m_vector(v, el.right + '0');
-}
 
-void copy_m_vector(m_vector const* src, m_vector* dest) {
-  if(dest->size < src->size) {
-    resize_m_vector(dest, src->size);
+bool parse_hand_line(char const* line, DominoTile* tiles, int* n) {
+  char const* p = line;
+  char* end;
+  int values[2];
+  int count = 0;
+
+  *n = 0;
+  while(true) {
+    long value = strtol(p, &end, 10);
+    if(end == p) break;
+
+    values[count++] = (int)value;
+    if(count == 2) {
+      tiles[*n].left = values[0];
+      tiles[*n].right = values[1];
+      (*n)++;
+      count = 0;
+    }
+    p = end;
   }
 
-  dest->size = 0;
-  for(int i=0; i<src->size; i++) {
-    _push_back_m_vector(dest, src->data[i]);
-  } 
-}
+  //dopo l'ultimo intero sono ammessi solo spazi
+  while(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+    p++;
 
+  return count == 0 && *p == '\0';
+}
 
-/*
-Funzioni per la gestione delle regole di gioco
-*/
-
-vector* generate_random_hand() {
-  vector* hand = create_vector();
-  Tile el;
-	char* values[] = {
-										"11", "12", "13", "14", "15", "16",
-										"21", "22", "23", "24", "25", "26",
-										"31", "32", "33", "34", "35", "36",
-										"41", "42", "43", "44", "45", "46",
-										"51", "52", "53", "54", "55", "56",
-										"61", "62", "63", "64", "65", "66",
-										"sum", "any", "mirror"
-										};
-
-  srand(time(NULL));
-
-  for(int i=0; i<HAND_SIZE; i++) {
-    int index = rand()%39;
-    int left;
-    int right;
-
-    if(strcmp(values[index], "sum") == 0) {
-      left = 11;
-      right = 11;
-    } else if(strcmp(values[index], "any") == 0) {
-      left = 0;
-      right = 0;
-    } else if(strcmp(values[index], "mirror") == 0) {
-      left = 12;
-      right = 21;
-    } else {
-      left = values[index][0] - '0';
-      right = values[index][1] - '0';
+void* batch_worker(void* arg) {
+  BatchWorker* w = (BatchWorker*)arg;
+  Batch* b = w->batch;
+
+  while(true) {
+    int i = atomic_fetch_add(&b->next, 1);
+    if(i >= b->count) break;
+
+    BatchJob* job = &b->jobs[i];
+    //ogni coppia di interi occupa almeno quattro caratteri, spazi compresi
+    DominoTile* tiles = (DominoTile*)malloc(sizeof(DominoTile) * (strlen(job->line)/4 + 1));
+    int n;
+    if(tiles == NULL) {
+      job->status = DOMINO_ERR_NO_MEMORY;
+      continue;
+    }
+    if(!parse_hand_line(job->line, tiles, &n)) {
+      job->status = DOMINO_ERR_INVALID_HAND;
+      free(tiles);
+      continue;
     }
 
-    el.right = right;
-    el.left = left;
-    push_back(hand, el);
+    long long start = clock_us();
+    job->status = domino_solve(w->solver, tiles, n, &job->result);
+    job->time_ms = (clock_us() - start) / 1000.0;
+    free(tiles);
   }
 
-  return hand;
+  return NULL;
 }
 
-bool delete_tile(vector* v, Tile el) {
-  int left = el.left;
-  int right = el.right;
-
-  for(size_t i=0; i<v->size; i++) {
-    if(v->data[i].left == left && v->data[i].right == right) {
-      delete_at(v, i);
-      return true;
+void batch_mode(Options const* opt) {
+  FILE* in = stdin;
+  if(strcmp(opt->batch, "-") != 0) {
+    in = fopen(opt->batch, "r");
+    if(in == NULL) {
+      printf("[+]Error: Cannot open %s. Exiting program", opt->batch);
+      exit(EXIT_FAILURE);
     }
   }
 
-  return false;
-}
-
-void move_tile(vector* field, vector* hand, char pos, Tile el) {
-  if(valid_move(field, pos, el)) {
-    bool present = delete_tile(hand, el);
-
-    if(pos == 'S' && present)
-      push_back(field, el);
-    
-    else if(pos == 'R' && present) {
-      if(el.left == 11 && el.right == 11) {
-        //Aggiungo +1 in tutto il campo
-        for(size_t i=0; i<field->size; i++) {
-          field->data[i].left += 1;
-          field->data[i].right += 1;
-        }
+  //le mani vengono risolte in parallelo, ognuna da un solo thread con il proprio contesto
+  int n_threads = opt->solver.threads;
+  DominoOptions solver_opt = opt->solver;
+  solver_opt.threads = 1;
+  solver_opt.tt_mb = opt->solver.tt_mb / n_threads;
+  solver_opt.progress = NULL;
+
+  int chunk = BATCH_CHUNK * n_threads;
+  Batch b;
+  b.jobs = (BatchJob*)calloc(chunk, sizeof(BatchJob));
+  BatchWorker* workers = (BatchWorker*)calloc(n_threads, sizeof(BatchWorker));
+  pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * n_threads);
+  if(b.jobs == NULL || workers == NULL || threads == NULL) {
+    printf("[+]Error: Memory allocation failed. Exiting program");
+    exit(EXIT_FAILURE);
+  }
+  for(int i=0; i<n_threads; i++) {
+    workers[i].batch = &b;
+    //i contesti condividono il seme, ognuno con il proprio flusso del generatore
+    check_status(domino_solver_create(&solver_opt, opt->seed, (uint64_t)i, &workers[i].solver));
+  }
 
-        //imposto la tessera {+1} uguale all'ultima
-        el = field->data[field->size-1];
-      } else if (el.left == 12 && el.right == 21) {
-        //imposto la [12|21] tessera come l'inverso di quella adiacente
-        el.right = field->data[field->size-1].left;
-        el.left = field->data[field->size-1].right;
+  //scarto dall'ottimo delle partite del motore a fascio, per le mani di cui l'ottimo è noto
+  int beam_hands = 0;
+  int beam_known = 0;
+  double gap_sum = 0;
+  double gap_max = 0;
+
+  bool eof = false;
+  while(!eof) {
+    //lettura del prossimo gruppo di mani, saltando righe vuote e commenti
+    b.count = 0;
+    while(b.count < chunk) {
+      size_t capacity = 0;
+      char* line = NULL;
+      if(getline(&line, &capacity, in) < 0) {
+        free(line);
+        eof = true;
+        break;
       }
-      
-      push_back(field, el);
-    }
-    else if(pos == 'L' && present) {
-      if(el.left == 11 && el.right == 11) {
-        //Aggiungo 1 in tutto il campo
-        for(size_t i=0; i<field->size; i++) {
-          field->data[i].left += 1;
-          field->data[i].right += 1;
-        }
 
-        //imposto la tessera {+1} uguale alla prima
-        el = field->data[0];
-      } else if(el.left == 12 && el.right == 21) {
-        el.left = field->data[0].right;
-        el.right = field->data[0].left;
+      char const* p = line;
+      while(*p == ' ' || *p == '\t') p++;
+      if(*p == '\n' || *p == '\r' || *p == '\0' || *p == '#') {
+        free(line);
+        continue;
       }
 
-      push_front(field, el);
+      b.jobs[b.count++].line = line;
     }
-  }
-}
-
-bool valid_move(vector const* field, char pos, Tile el) {
-  //Se la posizione scelta non è destra o sinistra, la mossa non è valida
-  if(pos != 'R' && pos != 'L' && pos != 'S') return false;
-  //Se il campo è vuoto e la tessera non è speciale, la mossa è sempre valida
-  if(field->size == 0 && el.left != 11 && el.right != 12) return true;
-  //Se la tessera è speciale, la mossa è sempre valida
-  if((el.left == 0 && el.right == 0) || (el.left == 11 && el.right == 11) || (el.left == 12 && el.right == 21)) return true;
-
-  int last_el = field->size-1;
-  if (pos == 'L') {
-    //se il primo numero del campo è uguale a left o right della tessera del giocatore
-    if( field->data[0].left == el.left ||
-        field->data[0].left == el.right ||
-        field->data[0].left == 0)
-        return true;
-  } else if (pos == 'R') {
-    //se l'ultimo numero del campo è uguale a left o right della tessera del giocatore
-    if( field->data[last_el].right == el.left ||
-        field->data[last_el].right == el.right ||
-        field->data[last_el].right == 0)
-      return true;
-  }
 
-  return false;
-}
+    if(b.count == 0) break;
+    atomic_init(&b.next, 0);
+
+    for(int i=0; i<n_threads; i++)
+      pthread_create(&threads[i], NULL, batch_worker, &workers[i]);
+    for(int i=0; i<n_threads; i++)
+      pthread_join(threads[i], NULL);
+
+    //i risultati vengono scritti nell'ordine di lettura
+    for(int i=0; i<b.count; i++) {
+      BatchJob* job = &b.jobs[i];
+
+      if(job->status == DOMINO_OK) {
+        printf("%d\t%d\t%llu\t%.3f\t", job->result.total, job->result.proven ? 1 : 0,
+               (unsigned long long)job->result.nodes, job->time_ms);
+        write_moves(stdout, &job->result);
+        printf("\n");
+        if(opt->stats)
+          domino_result_print_stats(&job->result, stderr);
+        if(opt->solver.engine == DOMINO_ENGINE_BEAM) {
+          beam_hands++;
+          if(job->result.optimum > 0) {
+            double gap = 100.0 * (job->result.optimum - job->result.total) / job->result.optimum;
+            beam_known++;
+            gap_sum += gap;
+            if(gap > gap_max)
+              gap_max = gap;
+          } else if(job->result.optimum == 0) {
+            beam_known++;
+          }
+        }
+        domino_result_free(&job->result);
+      } else {
+        printf("error\n");
+      }
 
-bool possible_moves(vector const* field, vector const* hand) {
-  if(field->size == 0) return true;
-
-
-  bool possible = false;
-  int field_ldata = field->data[0].left;
-  int field_rdata = field->data[field->size-1].right;
-  
-  //per ogni tessera in mano al giocatore controllo se la prima o l'ultima tessera del campo sono compatibili
-  for(size_t i=0; i<hand->size && !possible; i++) {
-    int hand_ldata = hand->data[i].left;
-    int hand_rdata = hand->data[i].right;
-
-    if( hand_ldata == field_ldata ||
-        hand_rdata == field_ldata ||
-        hand_rdata == field_rdata ||
-        hand_ldata == field_rdata ||
-        field_rdata == 0 || field_ldata == 0 ||
-        (hand_ldata == 0 && hand_rdata == 0) ||
-        (hand_ldata == 12 && hand_rdata == 21) ||
-        (hand_ldata == 11 && hand_rdata == 11))
-      possible = true;
+      free(job->line);
+    }
+    fflush(stdout);
   }
 
-  return possible;
+  if(opt->solver.engine == DOMINO_ENGINE_BEAM)
+    fprintf(stderr, "#beam hands %d known %d mean_gap %.2f%% max_gap %.2f%%\n", beam_hands, beam_known,
+            beam_known > 0 ? gap_sum / beam_known : 0.0, gap_max);
+
+  if(in != stdin)
+    fclose(in);
+  for(int i=0; i<n_threads; i++)
+    domino_solver_free(workers[i].solver);
+  free(workers);
+  free(threads);
+  free(b.jobs);
 }
 
-/**
- * @brief Funzione ausiliaria che calcola ricorsivamente il punteggio massimo data una tessera di partenza
- * @param field vector che rappresenta il campo di gioco
- * @param hand vector che rappresenta la mano del giocatore
- * @param max_moves m_vector che rappresenta le mosse effettuate per avere il massimo punteggio
- * @param el tessera di partenza di cui calcolare il punteggio massimo
- * @return Il numero di punti massimo effettuabile data la tessera iniziale
+/*
+Funzioni per la stampa
 */
-int recursive_mode_aux(vector* field, vector* hand, m_vector* max_moves ,char pos, Tile el) {
-  if(!possible_moves(field, hand))
-    return points(field);
-
-  if(valid_move(field, pos, el)) {
-    move_tile(field, hand, pos, el);
-    push_back_m_vector(max_moves, el, pos);
-  }
-  else return 0;
 
-  int max_points = 0;
-
-  for(size_t i=0; i < hand->size; i++) {
-
-    int this_max_points_r = recursive_mode_aux(field, hand, max_moves, 'R', hand->data[i]);
-    int this_max_points_l = recursive_mode_aux(field, hand, max_moves, 'L', hand->data[i]);
+void print_field(DominoGame const* game, DominoTile* buffer) {
+  printf("\033[1;1H\033[2J");
+  printf("Field: ");
+  int n = domino_game_field(game, buffer, INT_MAX);
+  for(int i=0; i<n; i++)
+    printf("[%d|%d]", buffer[i].left, buffer[i].right);
 
-    if(this_max_points_r > this_max_points_l)
-      max_points = this_max_points_r;
-    else
-      max_points = this_max_points_l;
+  printf("\n");
 
-  }
+  printf("Hand: ");
+  n = domino_game_hand(game, buffer, INT_MAX);
+  for(int i=0; i<n; i++)
+    printf("[%d|%d]", buffer[i].left, buffer[i].right);
 
-  return max_points;
+  printf("\n");
 }
 
-int recursive_mode(vector* field, vector* hand) {
-  int max = 0;
-  
-  //creazione di vettori ausiliari
-  vector* mem_field = clone(field);
-  vector* mem_hand = clone(hand);
-  vector* max_field = create_vector();
-  vector* max_hand = create_vector();
-  m_vector* max_moves = create_m_vector();
-  
-
-  for(size_t i=0; i<hand->size; i++) {
-    m_vector* this_max_moves = create_m_vector();
-    progress_bar(i, hand->size);
-    int this_max = recursive_mode_aux(field, hand, this_max_moves, 'S', hand->data[i]);
-    
-    if(max < this_max) {
-      max = this_max;
-      copy_vector(field, max_field);
-      copy_vector(hand, max_hand);
-      copy_m_vector(this_max_moves, max_moves);
-    }
-
-    //Imposta il campo e la mano allo stato iniziale
-    copy_vector(mem_field, field);
-    copy_vector(mem_hand, hand);
-    free_m_vector(this_max_moves);
+void write_moves(FILE* out, DominoResult const* result) {
+  for(int i=0; i<result->n_moves; i++) {
+    DominoMove const* m = &result->moves[i];
+    fprintf(out, i == 0 ? "%c %d %d" : " %c %d %d", m->side, m->tile.left, m->tile.right);
   }
-
-  print_field(max_field, max_hand);
-  print_moves(max_moves);
-  free_vector(mem_field);
-  free_vector(mem_hand);
-  free_vector(max_field);
-  free_vector(max_hand);
-  free_m_vector(max_moves);
-  
-  return max;
 }
 
-int points(vector const* v) {
-  int sum = 0;
-
-  for(size_t i=0; i<v->size; i++)
-    sum = sum + v->data[i].left + v->data[i].right;
-
-  return sum;
+void print_moves(DominoResult const* result) {
+  printf("Moves: ");
+  write_moves(stdout, result);
 }
 
-void progress_bar(int p, int width) {
-  printf("\033[1;1H\033[2J");
-  printf("\n");
-
-  int progress = (int)((float)p/width * 100);
+/*
+Funzioni per le opzioni
+*/
 
-  for(int i=1; i<100; i++) {
-    if(i < progress) printf("%c", '|');
-    else printf("%c", '_');
-  }
-  printf("\nLoading: %d%% \n", progress);
+void options_init(Options* opt) {
+  domino_options_default(&opt->solver);
+  opt->batch = NULL;
+  opt->seed = 0;
+  opt->seeded = false;
+  opt->stats = false;
+  opt->progress = true;
+  opt->hints = false;
+  opt->cache = NULL;
+  opt->cache_mb = CACHE_DEFAULT_MB;
+  opt->tablebase = NULL;
+  opt->tablebase_gen = NULL;
+  opt->tablebase_tiles = TABLEBASE_DEFAULT_TILES;
 }
 
-void print_field(vector const* field, vector const* hand) {
-  printf("\033[1;1H\033[2J");
-  printf("Field: ");
-  for(size_t i=0; i<field->size; i++) {
-    printf("[%d|%d]", field->data[i].left, field->data[i].right);
+void parse_options(int argc, char** argv, Options* opt) {
+  options_init(opt);
+
+  for(int i=1; i<argc; i++) {
+    if(strcmp(argv[i], "--tt-mb") == 0 && i+1 < argc) {
+      opt->solver.tt_mb = strtoul(argv[++i], NULL, 10);
+    } else if(strcmp(argv[i], "--threads") == 0 && i+1 < argc) {
+      opt->solver.threads = atoi(argv[++i]);
+      if(opt->solver.threads < 1)
+        opt->solver.threads = 1;
+    } else if(strcmp(argv[i], "--time-ms") == 0 && i+1 < argc) {
+      opt->solver.time_ms = strtol(argv[++i], NULL, 10);
+    } else if(strcmp(argv[i], "--nodes") == 0 && i+1 < argc) {
+      opt->solver.max_nodes = strtoull(argv[++i], NULL, 10);
+    } else if(strcmp(argv[i], "--batch") == 0 && i+1 < argc) {
+      opt->batch = argv[++i];
+    } else if(strcmp(argv[i], "--seed") == 0 && i+1 < argc) {
+      opt->seed = strtoull(argv[++i], NULL, 10);
+      opt->seeded = true;
+    } else if(strcmp(argv[i], "--stats") == 0) {
+#ifndef DOMINO_STATS
+      printf("[+]Error: --stats requires a build with -DDOMINO_STATS. Exiting program");
+      exit(EXIT_FAILURE);
+#endif
+      opt->stats = true;
+    } else if(strcmp(argv[i], "--stats-interval") == 0 && i+1 < argc) {
+      opt->solver.stats_interval = strtol(argv[++i], NULL, 10);
+    } else if(strcmp(argv[i], "--cache") == 0 && i+1 < argc) {
+      opt->cache = argv[++i];
+    } else if(strcmp(argv[i], "--cache-mb") == 0 && i+1 < argc) {
+      opt->cache_mb = strtoul(argv[++i], NULL, 10);
+    } else if(strcmp(argv[i], "--tablebase") == 0 && i+1 < argc) {
+      opt->tablebase = argv[++i];
+    } else if(strcmp(argv[i], "--tablebase-gen") == 0 && i+1 < argc) {
+      opt->tablebase_gen = argv[++i];
+    } else if(strcmp(argv[i], "--tablebase-tiles") == 0 && i+1 < argc) {
+      opt->tablebase_tiles = atoi(argv[++i]);
+    } else if(strcmp(argv[i], "--hints") == 0) {
+      opt->hints = true;
+    } else if(strcmp(argv[i], "--no-progress") == 0) {
+      opt->progress = false;
+    } else if(strcmp(argv[i], "--engine") == 0 && i+1 < argc && strcmp(argv[i+1], "search") == 0) {
+      opt->solver.engine = DOMINO_ENGINE_SEARCH;
+      i++;
+    } else if(strcmp(argv[i], "--engine") == 0 && i+1 < argc && strcmp(argv[i+1], "graph") == 0) {
+      opt->solver.engine = DOMINO_ENGINE_GRAPH;
+      i++;
+    } else if(strcmp(argv[i], "--engine") == 0 && i+1 < argc && strcmp(argv[i+1], "beam") == 0) {
+      opt->solver.engine = DOMINO_ENGINE_BEAM;
+      i++;
+    } else if(strcmp(argv[i], "--beam-width") == 0 && i+1 < argc) {
+      opt->solver.beam_width = atoi(argv[++i]);
+      if(opt->solver.beam_width < 1)
+        opt->solver.beam_width = 1;
+    } else if(strcmp(argv[i], "--beam-exact") == 0) {
+      opt->solver.beam_exact = true;
+    } else {
+      printf("Usage: %s [--tt-mb MB] [--threads N] [--time-ms MS] [--nodes N] [--batch FILE] "
+             "[--seed N] [--stats] [--stats-interval MS] [--engine search|graph|beam] [--no-progress] [--hints] "
+             "[--cache FILE] [--cache-mb MB] [--tablebase FILE] [--tablebase-gen FILE] [--tablebase-tiles N] [--beam-width W] [--beam-exact]\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
   }
 
-  printf("\n");
+  //le statistiche periodiche e l'avanzamento vengono scritti su stderr
+  if(opt->stats)
+    opt->solver.stats = stderr;
+  if(opt->progress)
+    opt->solver.progress = stderr;
+}
 
-  printf("Hand: ");
-  for(size_t i=0; i<hand->size; i++) {
-    printf("[%d|%d]", hand->data[i].left, hand->data[i].right);
+int main(int argc, char** argv) {
+  char in;
+  Options opt;
+  parse_options(argc, argv, &opt);
+
+  if(opt.tablebase_gen != NULL) {
+    int status = domino_tablebase_generate(opt.tablebase_gen, opt.tablebase_tiles, opt.solver.threads, stderr);
+    if(status == DOMINO_ERR_INVALID_ARGUMENT) {
+      printf("[+]Error: The tablebase covers at most %d tiles. Exiting program", DOMINO_TABLEBASE_MAX_TILES);
+      exit(EXIT_FAILURE);
+    } else if(status == DOMINO_ERR_IO) {
+      printf("[+]Error: Cannot write %s. Exiting program", opt.tablebase_gen);
+      exit(EXIT_FAILURE);
+    }
+    check_status(status);
+    return 0;
   }
 
-  printf("\n");
-}
-
-void print_moves(m_vector const* moves) {
-  printf("Moves: ");
-  for(int i=0; i<moves->size; i++) {    
-    if(moves->data[i] == 59) {
-      printf("11 ");
+  //la tablebase viene mappata una volta sola e condivisa da tutte le ricerche
+  DominoTablebase* tb = NULL;
+  if(opt.tablebase != NULL) {
+    int status = domino_tablebase_load(opt.tablebase, &tb);
+    if(status == DOMINO_ERR_IO) {
+      printf("[+]Error: Cannot open %s. Exiting program", opt.tablebase);
+      exit(EXIT_FAILURE);
+    } else if(status == DOMINO_ERR_BAD_FILE) {
+      printf("[+]Error: %s is not a tablebase or is truncated. Exiting program", opt.tablebase);
+      exit(EXIT_FAILURE);
     }
-    else if (moves->data[i] == 60) {
-      printf("12 ");
-    } else if (moves->data[i] == 69) {
-      printf("21 ");
-      } else {
-      printf("%c ", moves->data[i]);
+    check_status(status);
+    opt.solver.tablebase = tb;
+  }
+
+  //una cache che non può essere aperta viene solo segnalata: le ricerche procedono senza
+  DominoCache* cache = NULL;
+  if(opt.cache != NULL) {
+    int status = domino_cache_open(opt.cache, opt.cache_mb, &cache);
+    if(status == DOMINO_ERR_IO) {
+      fprintf(stderr, "[+]Warning: Cannot open %s.lock, the cache is disabled\n", opt.cache);
+    } else if(status == DOMINO_ERR_BAD_FILE) {
+      fprintf(stderr, "[+]Warning: %s is not a result cache, the cache is disabled\n", opt.cache);
+    } else {
+      check_status(status);
     }
+    opt.solver.cache = cache;
   }
-}
 
-int main() {
-  char in;
-  vector* player_hand = create_vector();
+  //senza --seed il seme cambia ad ogni esecuzione, anche nello stesso secondo
+  if(!opt.seeded)
+    opt.seed = (uint64_t)time(NULL) ^ domino_seed_mix(clock_us());
+
+  if(opt.batch != NULL) {
+    batch_mode(&opt);
+  } else {
+    DominoSolver* solver;
+    check_status(domino_solver_create(&opt.solver, opt.seed, 0, &solver));
+
+    DominoTile* tiles = NULL;
+    int n = 0;
+
+    printf("Any input tiles? y/n\n");
+    scanf(" %c", &in);
+
+    if (in == 'y'|| in == 'Y') {
+      scanf(" %d", &n);
+      if(n < 0)
+        n = 0;
+      tiles = (DominoTile*)malloc(sizeof(DominoTile) * (n > 0 ? n : 1));
+      if(tiles == NULL) {
+        printf("[+]Error: Memory allocation failed. Exiting program");
+        exit(EXIT_FAILURE);
+      }
 
+      //Lettura delle tessere da stdin
+      for (int i = 0; i < n; i++)
+        scanf("%d %d", &tiles[i].left, &tiles[i].right);
+    }
+    else if (in == 'n' || in == 'N') {
+      n = HAND_SIZE;
+      tiles = (DominoTile*)malloc(sizeof(DominoTile) * n);
+      if(tiles == NULL) {
+        printf("[+]Error: Memory allocation failed. Exiting program");
+        exit(EXIT_FAILURE);
+      }
+      domino_random_hand(solver, tiles, n);
+    }
 
-	printf("Any input tiles? y/n\n");
-	scanf(" %c", &in);
+    //La partita controlla la mano e la memorizza come numero di tessere per tipo
+    DominoGame* game;
+    check_status(domino_game_create(solver, tiles, n, &game));
+
+    printf("Mode selection: \n1. Interactive\n2. AI\n");
+    scanf(" %c", &in);
+
+    if(in == INTERACTIVE_MODE) {
+      int left;
+      int right;
+      char pos;
+      DominoTile* buffer = (DominoTile*)malloc(sizeof(DominoTile) * (n > 0 ? n : 1));
+      if(buffer == NULL) {
+        printf("[+]Error: Memory allocation failed. Exiting program");
+        exit(EXIT_FAILURE);
+      }
 
-  if (in == 'y'|| in == 'Y') {
-		int input_size;
-		scanf(" %d", &input_size);
+      //i suggerimenti vengono calcolati mentre il giocatore pensa
+      if(opt.hints)
+        check_status(domino_game_start_hints(game));
+
+      //main game loop
+      while(domino_game_can_move(game)) {
+        print_field(game, buffer);
+        printf("\nPlayer move%s: ", opt.hints ? " (H for a hint)" : "");
+        if(scanf(" %c", &pos) != 1)
+          break;
+        while(opt.hints && (pos == 'H' || pos == 'h')) {
+          print_hint(game);
+          printf("Player move: ");
+          if(scanf(" %c", &pos) != 1)
+            break;
+        }
+        if(scanf("%d %d", &left, &right) != 2)
+          break;
+
+        //creazione della tessera in base all'input del giocatore, una mossa non valida viene ignorata
+        DominoTile el;
+        el.left = left;
+        el.right = right;
+        domino_game_play(game, pos, el);
+      }
 
-		//Lettura delle tessere da stdin
-		for (int i = 0; i < input_size; i++) {
-			Tile el;
-      int left, right;
-			scanf("%d %d", &left, &right);
-      el.left = left;
-      el.right = right;  
-      push_back(player_hand, el);
+      print_field(game, buffer);
+      printf("Points: %d", domino_game_points(game));
+      free(buffer);
+    } else if (in == AI_MODE) {
+      printf("\nPoints: %d\n", recursive_mode(solver, tiles, n, &opt));
     }
-	} 
-  else if (in == 'n' || in == 'N') {
-    free_vector(player_hand);
-    player_hand = generate_random_hand();
+
+    domino_game_free(game);
+    free(tiles);
+    domino_solver_free(solver);
   }
 
-  printf("Mode selection: \n1. Interactive\n2. AI\n");
-	scanf(" %c", &in);
-
-  vector* field = create_vector();
-  if(in == INTERACTIVE_MODE) {
-		int left;
-		int right;
-		char pos;
-
-		//main game loop
-		while(possible_moves(field, player_hand)) {
-			print_field(field, player_hand);
-			printf("\nPlayer move: ");
-			scanf(" %c %d %d", &pos, &left, &right);
-      
-      //creazione della Tile in base all'input del giocatore
-      Tile el;
-      el.left = left;
-      el.right = right;
-
-			move_tile(field, player_hand, pos, el);
-		}
-
-    print_field(field, player_hand);
-		printf("Points: %d", points(field));
-	} else if (in == AI_MODE) {
-    printf("\nPoints: %d\n", recursive_mode(field, player_hand));
-	}
-
-	free_vector(player_hand);
-	free_vector(field);
-	return 0;
-}
\ No newline at end of file
+  domino_cache_close(cache);
+  domino_tablebase_free(tb);
+  return 0;
+}
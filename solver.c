@@ -0,0 +1,3755 @@
+/**
+ * @file solver.c
+ * @author FafNir
+ * @brief Motore del gioco "Domino Lineare": regole, ricerca AI e contesto del risolutore della libreria libdomino.
+ * Non usa stato globale, non scrive su stdout e non termina il processo: anche la mancanza di memoria viene restituita
+ * come errore
+ */
+
+#include "engine.h"
+
+/*
+Funzioni per la gestione di Arena
+*/
+
+/**
+ * @brief Funzione ausiliaria che arrotonda una dimensione in byte all'allineamento dei blocchi di Arena
+ * @param bytes La dimensione da arrotondare
+ * @return La dimensione arrotondata
+*/
+static size_t _arena_round(size_t bytes) {
+  return (bytes + sizeof(max_align_t)-1) / sizeof(max_align_t) * sizeof(max_align_t);
+}
+
+/**
+ * @brief Funzione ausiliaria che alloca un blocco di Arena vuoto
+ * @param size Dimensione in byte dell'area dati
+ * @return Il nuovo blocco, NULL se la memoria non basta
+*/
+static ArenaBlock* _arena_block(size_t size) {
+  ArenaBlock* b = (ArenaBlock*)malloc(sizeof(ArenaBlock) + size);
+  if(b == NULL) return NULL;
+
+  b->next = NULL;
+  b->size = size;
+  b->used = 0;
+  return b;
+}
+
+static bool arena_init(Arena* arena, size_t block_size) {
+  arena->block_size = _arena_round(block_size > 0 ? block_size : ARENA_BLOCK_SIZE);
+  arena->head = _arena_block(arena->block_size);
+  arena->current = arena->head;
+
+  return arena->head != NULL;
+}
+
+static void arena_free(Arena* arena) {
+  ArenaBlock* b = arena->head;
+  while(b != NULL) {
+    ArenaBlock* next = b->next;
+    free(b);
+    b = next;
+  }
+
+  arena->head = NULL;
+  arena->current = NULL;
+}
+
+static void* arena_alloc(Arena* arena, size_t bytes) {
+  if(arena == NULL)
+    return malloc(bytes);
+
+  bytes = _arena_round(bytes);
+
+  //i blocchi dopo quello attuale sono liberi: vengono riusati prima di chiederne uno nuovo
+  ArenaBlock* b = arena->current;
+  while(b->used + bytes > b->size) {
+    if(b->next == NULL)
+      b->next = _arena_block(bytes > arena->block_size ? bytes : arena->block_size);
+    if(b->next == NULL) return NULL;
+    b = b->next;
+    b->used = 0;
+  }
+
+  arena->current = b;
+  void* p = (char*)b->data + b->used;
+  b->used += bytes;
+  return p;
+}
+
+static void arena_release(Arena* arena, void* p) {
+  if(arena == NULL)
+    free(p);
+}
+
+static ArenaMark arena_mark(Arena const* arena) {
+  ArenaMark mark;
+  mark.block = (arena != NULL) ? arena->current : NULL;
+  mark.used = (arena != NULL) ? arena->current->used : 0;
+  return mark;
+}
+
+static void arena_rewind(Arena* arena, ArenaMark mark) {
+  if(arena == NULL) return;
+
+  arena->current = mark.block;
+  arena->current->used = mark.used;
+}
+
+static void arena_reset(Arena* arena) {
+  arena->current = arena->head;
+  arena->current->used = 0;
+}
+
+
+/*
+Funzioni per la gestione di MoveStack
+*/
+
+static bool move_stack_init(MoveStack* ms, int capacity) {
+  ms->data = (MoveRecord*)malloc(sizeof(MoveRecord) * (capacity > 0 ? capacity : 1));
+  ms->size = 0;
+  ms->capacity = (ms->data != NULL) ? capacity : 0;
+
+  return ms->data != NULL;
+}
+
+static void move_stack_free(MoveStack* ms) {
+  free(ms->data);
+  ms->data = NULL;
+  ms->size = 0;
+  ms->capacity = 0;
+}
+
+static void move_stack_push(MoveStack* ms, Field const* field, Move const* move) {
+  //la pila viene creata con una mossa per ogni tessera della mano
+  assert(ms->size < ms->capacity);
+
+  Tile placed = (move->pos == 'L') ? field_front(field) : field_back(field);
+  MoveRecord* r = &ms->data[ms->size++];
+  r->move = *move;
+  r->left = (uint8_t)placed.left;
+  r->right = (uint8_t)placed.right;
+}
+
+
+/*
+Funzioni per la gestione di deque
+*/
+
+static deque* create_deque_in(Arena* arena) {
+  deque* d = (deque*)arena_alloc(arena, sizeof(deque));
+  if(d == NULL) return NULL;
+
+  d->size = 0;
+  d->capacity = 4;
+  d->head = 0;
+  d->reserved = 0;
+  d->arena = arena;
+  d->data = (PackedTile*)arena_alloc(arena, sizeof(PackedTile)*d->capacity);
+  if(d->data == NULL) {
+    arena_release(arena, d);
+    return NULL;
+  }
+
+  return d;
+}
+
+static void free_deque(deque* d) {
+  Arena* arena = d->arena;
+
+  arena_release(arena, d->data);
+  arena_release(arena, d);
+}
+
+static bool resize_deque(deque* d, size_t new_capacity) {
+  PackedTile* new_data = (PackedTile*)arena_alloc(d->arena, sizeof(PackedTile) * new_capacity);
+  if(new_data == NULL) return false;
+
+  //gli elementi possono essere divisi in due parti: dalla testa alla fine del buffer e dall'inizio del buffer
+  size_t first_part = d->capacity - d->head;
+  if(first_part > d->size)
+    first_part = d->size;
+
+  memcpy(new_data, d->data + d->head, first_part*sizeof(PackedTile));
+  memcpy(new_data + first_part, d->data, (d->size - first_part)*sizeof(PackedTile));
+
+  arena_release(d->arena, d->data);
+
+  d->data = new_data;
+  d->capacity = new_capacity;
+  d->head = 0;
+  return true;
+}
+
+static bool reserve_deque(deque* d, size_t n) {
+  size_t capacity = d->capacity;
+  while(capacity < n)
+    capacity *= 2;
+
+  if(capacity > d->capacity && !resize_deque(d, capacity))
+    return false;
+  if(d->reserved < capacity)
+    d->reserved = capacity;
+  return true;
+}
+
+static void push_back_deque(deque* d, PackedTile el) {
+  //lo spazio viene riservato prima, quindi un inserimento non alloca mai
+  assert(d->size < d->capacity);
+
+  d->data[(d->head + d->size) & (d->capacity-1)] = el;
+  d->size += 1;
+}
+
+static void push_front_deque(deque* d, PackedTile el) {
+  assert(d->size < d->capacity);
+
+  d->head = (d->head + d->capacity - 1) & (d->capacity-1);
+  d->data[d->head] = el;
+  d->size += 1;
+}
+
+/**
+ * @brief Dimezza la capacità del deque solo quando è occupato per meno di un quarto,
+ * così un deque che oscilla intorno a metà capacità non viene riallocato ad ogni mossa.
+ * Se la memoria per il buffer più piccolo non basta il deque resta com'è
+ * @param d Il deque da controllare
+*/
+static void _shrink_deque(deque* d) {
+  if(d->capacity > 16 && d->capacity > d->reserved && d->size <= d->capacity/4)
+    resize_deque(d, d->capacity/2);
+}
+
+static void pop_back_deque(deque* d) {
+  assert(d->size > 0);
+
+  d->size -= 1;
+  _shrink_deque(d);
+}
+
+static void pop_front_deque(deque* d) {
+  assert(d->size > 0);
+
+  d->head = (d->head + 1) & (d->capacity-1);
+  d->size -= 1;
+  _shrink_deque(d);
+}
+
+static PackedTile* get_deque(deque const* d, size_t index) {
+  return &d->data[(d->head + index) & (d->capacity-1)];
+}
+
+/*
+Funzioni per la gestione di Field
+*/
+
+static Field* create_field() {
+  return create_field_in(NULL);
+}
+
+static Field* create_field_in(Arena* arena) {
+  Field* field = (Field*)arena_alloc(arena, sizeof(Field));
+  if(field == NULL) return NULL;
+
+  field->tiles = create_deque_in(arena);
+  if(field->tiles == NULL) {
+    arena_release(arena, field);
+    return NULL;
+  }
+  field->offset = 0;
+  field->total = 0;
+
+  return field;
+}
+
+static void free_field(Field* field) {
+  if(field == NULL) return;
+
+  Arena* arena = field->tiles->arena;
+
+  free_deque(field->tiles);
+  arena_release(arena, field);
+}
+
+static Field* clone_field(Field const* field) {
+  Field* c = create_field();
+  if(c != NULL && !copy_field(field, c)) {
+    free_field(c);
+    return NULL;
+  }
+
+  return c;
+}
+
+static bool copy_field(Field const* src, Field* dest) {
+  //la copia non va ridimensionata durante la ricerca più dell'originale
+  if(!reserve_deque(dest->tiles, src->tiles->reserved > src->tiles->size ? src->tiles->reserved : src->tiles->size))
+    return false;
+
+  dest->tiles->size = 0;
+  dest->tiles->head = 0;
+  for(size_t i=0; i<src->tiles->size; i++)
+    push_back_deque(dest->tiles, *get_deque(src->tiles, i));
+  dest->offset = src->offset;
+  dest->total = src->total;
+  return true;
+}
+
+static Tile field_at(Field const* field, size_t index) {
+  PackedTile const* p = get_deque(field->tiles, index);
+  Tile el;
+  el.left = p->left + field->offset;
+  el.right = p->right + field->offset;
+  return el;
+}
+
+static Tile field_front(Field const* field) {
+  return field_at(field, 0);
+}
+
+static Tile field_back(Field const* field) {
+  return field_at(field, field->tiles->size-1);
+}
+
+static void field_push(Field* field, char pos, Tile el) {
+  field->total += el.left + el.right;
+
+  //al netto dell'offset i valori restano tra -HAND_SUM_MAX e 6: una [11|11] o una [12|21] copia quelli adiacenti
+  PackedTile p;
+  p.left = (int8_t)(el.left - field->offset);
+  p.right = (int8_t)(el.right - field->offset);
+
+  if(pos == 'L')
+    push_front_deque(field->tiles, p);
+  else
+    push_back_deque(field->tiles, p);
+}
+
+static void field_pop(Field* field, char pos) {
+  Tile el = (pos == 'L') ? field_front(field) : field_back(field);
+  field->total -= el.left + el.right;
+
+  if(pos == 'L')
+    pop_front_deque(field->tiles);
+  else
+    pop_back_deque(field->tiles);
+}
+
+
+/*
+Funzioni per la gestione di Hand
+*/
+
+static int tile_kind(Tile el) {
+  if(is_sum(el)) return SUM_KIND;
+  if(is_any(el)) return ANY_KIND;
+  if(is_mirror(el)) return MIRROR_KIND;
+  if(el.left < 1 || el.left > 6 || el.right < 1 || el.right > 6) return -1;
+
+  return (el.left-1)*6 + (el.right-1);
+}
+
+static Tile kind_tile(int kind) {
+  Tile el;
+
+  if(kind == SUM_KIND) {
+    el.left = 11;
+    el.right = 11;
+  } else if(kind == ANY_KIND) {
+    el.left = 0;
+    el.right = 0;
+  } else if(kind == MIRROR_KIND) {
+    el.left = 12;
+    el.right = 21;
+  } else {
+    el.left = kind/6 + 1;
+    el.right = kind%6 + 1;
+  }
+
+  return el;
+}
+
+static uint64_t value_kinds(int v) {
+  if(v < 1 || v > 6) return 0;
+
+  //riga dei tipi [v|x] e colonna dei tipi [x|v]
+  return (0x3FULL << (6*(v-1))) | (0x041041041ULL << (v-1));
+}
+
+static void hand_init(Hand* hand) {
+  memset(hand, 0, sizeof(Hand));
+}
+
+static void hand_add(Hand* hand, int kind) {
+  hand->count[kind] += 1;
+  hand->present |= 1ULL << kind;
+  hand->size += 1;
+  hand->pips += kind_pips(kind);
+}
+
+static void hand_remove(Hand* hand, int kind) {
+  hand->count[kind] -= 1;
+  if(hand->count[kind] == 0)
+    hand->present &= ~(1ULL << kind);
+  hand->size -= 1;
+  hand->pips -= kind_pips(kind);
+}
+
+static int kind_pips(int kind) {
+  if(kind >= SUM_KIND) return 0;
+
+  return kind/6 + kind%6 + 2;
+}
+
+static int canonical_kind(int kind) {
+  if(kind >= SUM_KIND) return kind;
+
+  int a = kind / 6;
+  int b = kind % 6;
+  return a <= b ? kind : b*6 + a;
+}
+
+static bool symmetric_field(Field const* field) {
+  if(field->tiles->size == 0) return false;
+
+  Tile first = field_front(field);
+  Tile last = field_back(field);
+  return first.left == last.right && first.right == last.left;
+}
+
+static bool hand_matches(Hand const* hand, int v) {
+  //un estremo [0|0] accetta qualsiasi tessera
+  if(v == 0) return hand->size > 0;
+
+  uint64_t specials = (1ULL << SUM_KIND) | (1ULL << ANY_KIND) | (1ULL << MIRROR_KIND);
+  return (hand->present & (value_kinds(v) | specials)) != 0;
+}
+
+
+/*
+Funzioni per la gestione della tabella delle trasposizioni
+*/
+
+static bool tt_create(TTable* tt, size_t mb) {
+  size_t pairs = 1;
+
+  tt->entries = NULL;
+  tt->mask = 0;
+  if(mb == 0) return true;
+
+  //numero di coppie pari alla massima potenza di 2 che sta nella memoria richiesta
+  while(pairs*2 * 2*sizeof(TTEntry) <= mb*1024*1024)
+    pairs *= 2;
+
+  tt->entries = (TTEntry*)calloc(pairs*2, sizeof(TTEntry));
+  if(tt->entries == NULL) return false;
+  tt->mask = pairs-1;
+  return true;
+}
+
+static void tt_free(TTable* tt) {
+  free(tt->entries);
+  tt->entries = NULL;
+}
+
+static bool tt_probe(TTable const* tt, uint64_t key, int* lo, int* hi) {
+  if(tt->entries == NULL) return false;
+
+  TTEntry const* bucket = &tt->entries[(key & tt->mask)*2];
+  for(int i=0; i<2; i++) {
+    uint64_t data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&bucket[i].check, memory_order_relaxed);
+
+    if((check ^ data) == key) {
+      *lo = (int)(data & 0xFFFFFF);
+      *hi = (int)((data >> 24) & 0xFFFFFF);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void tt_store(TTable* tt, uint64_t key, int lo, int hi, int depth) {
+  if(tt->entries == NULL) return;
+
+  TTEntry* bucket = &tt->entries[(key & tt->mask)*2];
+  TTEntry* e;
+
+  //il primo elemento conserva le posizioni con più tessere in mano (più costose da ricalcolare), il secondo viene sempre sostituito
+  uint64_t first = atomic_load_explicit(&bucket[0].data, memory_order_relaxed);
+  uint64_t first_key = atomic_load_explicit(&bucket[0].check, memory_order_relaxed) ^ first;
+  if(first_key == key || (int)(first >> 48) <= depth)
+    e = &bucket[0];
+  else
+    e = &bucket[1];
+
+  if(hi > 0xFFFFFF) hi = 0xFFFFFF;
+  if(lo > hi) lo = hi;
+  uint64_t data = (uint64_t)lo | ((uint64_t)hi << 24) | ((uint64_t)(depth & 0xFFFF) << 48);
+
+  atomic_store_explicit(&e->data, data, memory_order_relaxed);
+  atomic_store_explicit(&e->check, key ^ data, memory_order_relaxed);
+}
+
+static uint64_t mix64(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+static uint64_t kind_key(int kind) {
+  //la chiave della mano è una somma: con mix64(k+1) valeva 2*mix64(15) == mix64(30), cioè due [3|3] come una [5|6]
+  return mix64(((uint64_t)canonical_kind(kind) + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+static uint64_t hand_key(Hand const* hand) {
+  uint64_t key = 0;
+
+  for(int k=0; k<TILE_KINDS; k++)
+    key += (uint64_t)hand->count[k] * kind_key(k);
+
+  return key;
+}
+
+static uint64_t field_key(Field const* field, uint64_t hand_key) {
+  uint64_t ends = 0;
+
+  if(field->tiles->size > 0) {
+    Tile first = field_front(field);
+    Tile last = field_back(field);
+    ends = ((uint64_t)(uint16_t)first.left << 48) | ((uint64_t)(uint16_t)first.right << 32) |
+           ((uint64_t)(uint16_t)last.left << 16) | (uint16_t)last.right;
+
+    //il campo letto da destra a sinistra ha lo stesso valore, perché la chiave della mano non distingue [a|b] da [b|a]
+    uint64_t mirrored = ((uint64_t)(uint16_t)last.right << 48) | ((uint64_t)(uint16_t)last.left << 32) |
+                        ((uint64_t)(uint16_t)first.right << 16) | (uint16_t)first.left;
+    if(mirrored < ends)
+      ends = mirrored;
+  }
+
+  uint64_t key = hand_key ^ mix64(ends ^ mix64(field->tiles->size + 1));
+  //la chiave 0 indica un elemento vuoto della tabella
+  return key != 0 ? key : 1;
+}
+
+static uint64_t position_key(Search const* s) {
+  return field_key(s->field, s->hand_key);
+}
+
+
+/*
+Funzioni per la generazione casuale
+*/
+
+static void rng_seed(Rng* rng, uint64_t seed, uint64_t stream) {
+  //lo stato viene riempito con la sequenza splitmix64 del seme, che non è mai tutta nulla
+  for(int i=0; i<4; i++)
+    rng->s[i] = mix64(seed + (uint64_t)(i+1) * 0x9e3779b97f4a7c15ULL);
+
+  for(uint64_t i=0; i<stream; i++)
+    rng_jump(rng);
+}
+
+static uint64_t rng_next(Rng* rng) {
+  uint64_t* s = rng->s;
+  uint64_t x = s[1] * 5;
+  uint64_t result = ((x << 7) | (x >> 57)) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 45) | (s[3] >> 19);
+
+  return result;
+}
+
+static void rng_jump(Rng* rng) {
+  static uint64_t const jump[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+  uint64_t s[4] = {0, 0, 0, 0};
+
+  for(int i=0; i<4; i++) {
+    for(int b=0; b<64; b++) {
+      if(jump[i] & (1ULL << b))
+        for(int j=0; j<4; j++)
+          s[j] ^= rng->s[j];
+      rng_next(rng);
+    }
+  }
+
+  memcpy(rng->s, s, sizeof(s));
+}
+
+static void sampler_init(KindSampler* sampler, uint32_t const weights[TILE_KINDS]) {
+  uint64_t total = 0;
+  for(int k=0; k<TILE_KINDS; k++)
+    total += weights[k];
+  //i pesi sono costanti del motore, mai tutti nulli
+  assert(total > 0);
+
+  //ogni colonna ha capacità total: le colonne sotto la media vengono completate con quelle sopra
+  uint64_t scaled[TILE_KINDS];
+  int small[TILE_KINDS], large[TILE_KINDS];
+  int n_small = 0, n_large = 0;
+
+  for(int k=0; k<TILE_KINDS; k++) {
+    scaled[k] = (uint64_t)weights[k] * TILE_KINDS;
+    sampler->alias[k] = k;
+    if(scaled[k] < total) small[n_small++] = k;
+    else large[n_large++] = k;
+  }
+
+  while(n_small > 0 && n_large > 0) {
+    int s = small[--n_small];
+    int l = large[n_large-1];
+
+    sampler->threshold[s] = (uint32_t)((scaled[s] << 32) / total);
+    sampler->alias[s] = l;
+    scaled[l] -= total - scaled[s];
+    if(scaled[l] < total) {
+      n_large--;
+      small[n_small++] = l;
+    }
+  }
+
+  //le colonne rimaste sono piene, a meno di errori di arrotondamento
+  while(n_large > 0)
+    sampler->threshold[large[--n_large]] = UINT32_MAX;
+  while(n_small > 0)
+    sampler->threshold[small[--n_small]] = UINT32_MAX;
+}
+
+static int sample_kind(KindSampler const* sampler, Rng* rng) {
+  uint64_t r = rng_next(rng);
+  int column = (int)(((r >> 32) * TILE_KINDS) >> 32);
+
+  return (uint32_t)r < sampler->threshold[column] ? column : sampler->alias[column];
+}
+
+/*
+Funzioni per la gestione delle regole di gioco
+*/
+
+static void generate_seeded_hand(uint64_t seed, int mix, Tile* tiles, int n) {
+  //un terzo di speciali: 36 tipi normali di peso 1 e 3 speciali di peso 6
+  uint32_t weights[TILE_KINDS];
+  for(int k=0; k<TILE_KINDS; k++) {
+    if(k < SUM_KIND) weights[k] = 1;
+    else if(mix == MIX_PLAIN) weights[k] = 0;
+    else if(mix == MIX_SPECIAL) weights[k] = 6;
+    else weights[k] = 1;
+  }
+
+  KindSampler sampler;
+  Rng rng;
+  sampler_init(&sampler, weights);
+  rng_seed(&rng, seed, 0);
+
+  for(int i=0; i<n; i++)
+    tiles[i] = kind_tile(sample_kind(&sampler, &rng));
+}
+
+static bool is_any(Tile el) {
+  return el.left == 0 && el.right == 0;
+}
+
+static bool is_sum(Tile el) {
+  return el.left == 11 && el.right == 11;
+}
+
+static bool is_mirror(Tile el) {
+  return el.left == 12 && el.right == 21;
+}
+
+static bool move_tile(Field* field, Hand* hand, char pos, Tile el) {
+  int kind = tile_kind(el);
+  Tile flipped = {el.right, el.left};
+  int flipped_kind = tile_kind(flipped);
+  Undo u;
+
+  if(kind < 0 || !valid_move(field, pos, el)) return false;
+
+  //la tessera può essere indicata in entrambi i versi
+  if(hand->count[kind] > 0)
+    make_move(field, hand, kind, pos, false, &u);
+  else if(flipped_kind >= 0 && hand->count[flipped_kind] > 0)
+    make_move(field, hand, flipped_kind, pos, true, &u);
+  else
+    return false;
+
+  return true;
+}
+
+static void make_move(Field* field, Hand* hand, int kind, char pos, bool flip, Undo* u) {
+  Tile el = kind_tile(kind);
+
+  u->kind = kind;
+  u->pos = pos;
+  u->sum = false;
+  u->total = field->total;
+
+  hand_remove(hand, kind);
+
+  if(flip) {
+    int tmp = el.left;
+    el.left = el.right;
+    el.right = tmp;
+  }
+
+  //la prima tessera viene inserita così com'è
+  if(pos == 'S' || field->tiles->size == 0) {
+    u->pos = 'R';
+    field_push(field, 'R', el);
+    return;
+  }
+
+  Tile adj = (pos == 'R') ? field_back(field) : field_front(field);
+
+  if(is_sum(el)) {
+    //Aggiungo +1 in tutto il campo incrementando l'offset, senza modificare le tessere memorizzate
+    field->offset += 1;
+    field->total += 2*(int)field->tiles->size;
+
+    //imposto la tessera {+1} uguale a quella adiacente
+    el.left = adj.left + 1;
+    el.right = adj.right + 1;
+    u->sum = true;
+  } else if(is_mirror(el)) {
+    //imposto la [12|21] tessera come l'inverso di quella adiacente
+    el.left = adj.right;
+    el.right = adj.left;
+  } else if(!is_any(el)) {
+    //giro la tessera in modo che la metà compatibile sia adiacente al campo
+    int end = (pos == 'R') ? adj.right : adj.left;
+    int near = (pos == 'R') ? el.left : el.right;
+    if(end != 0 && near != end) {
+      int tmp = el.left;
+      el.left = el.right;
+      el.right = tmp;
+    }
+  }
+
+  field_push(field, pos, el);
+}
+
+static void unmake_move(Field* field, Hand* hand, Undo const* u) {
+  field_pop(field, u->pos);
+
+  if(u->sum)
+    field->offset -= 1;
+  field->total = u->total;
+
+  hand_add(hand, u->kind);
+}
+
+static bool valid_move(Field const* field, char pos, Tile el) {
+  //Se la posizione scelta non è destra o sinistra, la mossa non è valida
+  if(pos != 'R' && pos != 'L' && pos != 'S') return false;
+  //Se il campo è vuoto si può iniziare con qualsiasi tessera, tranne [11|11] e [12|21] che agiscono sulla tessera adiacente
+  if(field->tiles->size == 0) return !is_sum(el) && !is_mirror(el);
+  //La posizione 'S' è ammessa solo come prima mossa
+  if(pos == 'S') return false;
+  //Se la tessera è speciale, la mossa è sempre valida
+  if(is_any(el) || is_sum(el) || is_mirror(el)) return true;
+
+  if (pos == 'L') {
+    //se il primo numero del campo è uguale a left o right della tessera del giocatore
+    int first = field_front(field).left;
+    if( first == el.left ||
+        first == el.right ||
+        first == 0)
+        return true;
+  } else if (pos == 'R') {
+    //se l'ultimo numero del campo è uguale a left o right della tessera del giocatore
+    int last = field_back(field).right;
+    if( last == el.left ||
+        last == el.right ||
+        last == 0)
+      return true;
+  }
+
+  return false;
+}
+
+static bool possible_moves(Field const* field, Hand const* hand) {
+  //a campo vuoto basta una tessera con cui iniziare
+  if(field->tiles->size == 0)
+    return playable_kinds(field, hand, 'S') != 0;
+
+  return hand_matches(hand, field_front(field).left) || hand_matches(hand, field_back(field).right);
+}
+
+static uint64_t playable_kinds(Field const* field, Hand const* hand, char pos) {
+  uint64_t specials = (1ULL << SUM_KIND) | (1ULL << ANY_KIND) | (1ULL << MIRROR_KIND);
+
+  //si inizia con qualsiasi tessera tranne [11|11] e [12|21]
+  if(field->tiles->size == 0)
+    return hand->present & ~((1ULL << SUM_KIND) | (1ULL << MIRROR_KIND));
+  if(pos == 'S')
+    return 0;
+
+  int end = (pos == 'R') ? field_back(field).right : field_front(field).left;
+  if(end == 0)
+    return hand->present;
+
+  return hand->present & (value_kinds(end) | specials);
+}
+
+static int move_gain(Field const* field, Undo const* u) {
+  return field->total - u->total;
+}
+
+static int special_gain(Field const* field, int kind, char pos) {
+  if(kind == ANY_KIND || field->tiles->size == 0) return 0;
+
+  Tile adj = (pos == 'R') ? field_back(field) : field_front(field);
+  //[12|21] copia la tessera adiacente, [11|11] la copia con +1 e aggiunge 2 punti per ogni tessera già nel campo
+  if(kind == MIRROR_KIND)
+    return adj.left + adj.right;
+
+  return 2*(int)field->tiles->size + adj.left + adj.right + 2;
+}
+
+/// @brief Valore di ogni tipo di tessera normale, con zeri fino alla dimensione dei vettori usati da max_pips_kind
+static uint8_t const KIND_PIPS[64] = {
+  2, 3, 4, 5, 6, 7, 3, 4, 5, 6, 7, 8, 4, 5, 6, 7, 8, 9, 5, 6, 7, 8, 9, 10,
+  6, 7, 8, 9, 10, 11, 7, 8, 9, 10, 11, 12
+};
+
+static int max_pips_kind(uint64_t kinds) {
+#if defined(__AVX2__)
+  //ogni byte del vettore contiene il byte della bitmask a cui appartiene il suo bit, selezionato da bits
+  __m256i const bits = _mm256_set1_epi64x(0x8040201008040201LL);
+  __m256i v[2];
+  for(int i=0; i<2; i++) {
+    uint32_t m = (uint32_t)(kinds >> (32*i));
+    __m256i spread = _mm256_set_epi64x((long long)(((m >> 24) & 0xFF) * 0x0101010101010101ULL),
+                                       (long long)(((m >> 16) & 0xFF) * 0x0101010101010101ULL),
+                                       (long long)(((m >> 8) & 0xFF) * 0x0101010101010101ULL),
+                                       (long long)((m & 0xFF) * 0x0101010101010101ULL));
+    __m256i selected = _mm256_cmpeq_epi8(_mm256_and_si256(spread, bits), bits);
+    v[i] = _mm256_and_si256(selected, _mm256_loadu_si256((__m256i const*)&KIND_PIPS[32*i]));
+  }
+
+  __m256i top = _mm256_max_epu8(v[0], v[1]);
+  __m128i m = _mm_max_epu8(_mm256_castsi256_si128(top), _mm256_extracti128_si256(top, 1));
+  m = _mm_max_epu8(m, _mm_srli_si128(m, 8));
+  m = _mm_max_epu8(m, _mm_srli_si128(m, 4));
+  m = _mm_max_epu8(m, _mm_srli_si128(m, 2));
+  m = _mm_max_epu8(m, _mm_srli_si128(m, 1));
+  __m256i best = _mm256_set1_epi8((char)_mm_cvtsi128_si32(m));
+
+  uint64_t hits = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v[0], best)) |
+                  ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v[1], best)) << 32);
+  return __builtin_ctzll(hits);
+#elif defined(__SSE2__)
+  //ogni byte del vettore contiene il byte della bitmask a cui appartiene il suo bit, selezionato da bits
+  __m128i const bits = _mm_set1_epi64x(0x8040201008040201LL);
+  __m128i v[3];
+  for(int i=0; i<3; i++) {
+    uint32_t m = (uint32_t)(kinds >> (16*i)) & 0xFFFF;
+    __m128i spread = _mm_set_epi64x((long long)((m >> 8) * 0x0101010101010101ULL),
+                                    (long long)((m & 0xFF) * 0x0101010101010101ULL));
+    __m128i selected = _mm_cmpeq_epi8(_mm_and_si128(spread, bits), bits);
+    v[i] = _mm_and_si128(selected, _mm_loadu_si128((__m128i const*)&KIND_PIPS[16*i]));
+  }
+
+  __m128i m = _mm_max_epu8(_mm_max_epu8(v[0], v[1]), v[2]);
+  m = _mm_max_epu8(m, _mm_srli_si128(m, 8));
+  m = _mm_max_epu8(m, _mm_srli_si128(m, 4));
+  m = _mm_max_epu8(m, _mm_srli_si128(m, 2));
+  m = _mm_max_epu8(m, _mm_srli_si128(m, 1));
+  __m128i best = _mm_set1_epi8((char)_mm_cvtsi128_si32(m));
+
+  uint64_t hits = 0;
+  for(int i=0; i<3; i++)
+    hits |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v[i], best)) << (16*i);
+  return __builtin_ctzll(hits);
+#else
+  int chosen = __builtin_ctzll(kinds);
+  for(uint64_t m = kinds & (kinds-1); m != 0; m &= m-1) {
+    int k = __builtin_ctzll(m);
+    if(KIND_PIPS[k] > KIND_PIPS[chosen])
+      chosen = k;
+  }
+  return chosen;
+#endif
+}
+
+static int greedy_move(Field const* field, Hand const* hand, Move* move) {
+  char const* sides = (field->tiles->size == 0) ? "S" : (symmetric_field(field) ? "R" : "RL");
+  int best = -1;
+
+  //l'ordine dei confronti è quello di list_moves: lato per lato, prima le tessere normali e poi le speciali
+  for(int p=0; sides[p] != '\0'; p++) {
+    uint64_t playable = playable_kinds(field, hand, sides[p]);
+    uint64_t normal = playable & ((1ULL << SUM_KIND) - 1);
+
+    if(normal != 0) {
+      int k = max_pips_kind(normal);
+      if(KIND_PIPS[k] > best) {
+        best = KIND_PIPS[k];
+        move->kind = k;
+        move->pos = sides[p];
+        move->flip = false;
+      }
+    }
+
+    for(int k=SUM_KIND; k<TILE_KINDS; k++) {
+      if(!(playable & (1ULL << k))) continue;
+
+      int gain = special_gain(field, k, sides[p]);
+      if(gain > best) {
+        best = gain;
+        move->kind = k;
+        move->pos = sides[p];
+        move->flip = false;
+      }
+    }
+  }
+
+  return best;
+}
+
+static int reachable_pips(Field const* field, Hand const* hand) {
+  uint64_t specials = (1ULL << SUM_KIND) | (1ULL << ANY_KIND);
+
+  if(field->tiles->size == 0 || (hand->present & specials) != 0)
+    return hand->pips;
+
+  Tile first = field_front(field);
+  Tile last = field_back(field);
+  if(first.left == 0 || last.right == 0)
+    return hand->pips;
+
+  //valori raggiungibili agli estremi: con una [12|21] anche la metà interna delle tessere agli estremi
+  unsigned reach = (1u << first.left) | (1u << last.right);
+  if(hand->count[MIRROR_KIND] > 0)
+    reach |= (1u << first.right) | (1u << last.left);
+
+  uint64_t left = hand->present & ((1ULL << SUM_KIND) - 1);
+  int pips = 0;
+  bool grown = true;
+
+  while(grown) {
+    grown = false;
+    for(uint64_t m = left; m != 0; m &= m-1) {
+      int k = __builtin_ctzll(m);
+      unsigned values = (1u << (k/6 + 1)) | (1u << (k%6 + 1));
+
+      if(reach & values) {
+        reach |= values;
+        pips += hand->count[k] * kind_pips(k);
+        left &= ~(1ULL << k);
+        grown = true;
+      }
+    }
+  }
+
+  return pips;
+}
+
+static int upper_bound(Field const* field, Hand const* hand) {
+  int n = (int)field->tiles->size;
+  int h = (int)hand->size;
+  int sums = hand->count[SUM_KIND];
+  int mirrors = hand->count[MIRROR_KIND];
+  //massimo valore reale che una metà di tessera può raggiungere prima della fine della partita
+  int top = 6 + field->offset + sums;
+
+  int bound = reachable_pips(field, hand) + mirrors*2*top;
+  //la j-esima [11|11] segue al più n + h - sums + j tessere e copia una tessera con valori al più 7 + offset + j
+  bound += sums*(2*(n + h - sums) + 14 + 2*field->offset) + 2*sums*(sums-1);
+
+  return bound;
+}
+
+/**
+ * @brief Funzione che calcola in quanti versi una tessera giocabile può essere inserita nel lato pos del campo
+ * @param field campo di gioco
+ * @param kind tipo della tessera da inserire
+ * @param pos lato del campo
+ * @return 2 se l'estremo è uno [0|0] e la tessera normale non è un doppio, 1 altrimenti
+*/
+static int orientations(Field const* field, int kind, char pos) {
+  if(field->tiles->size == 0 || kind >= SUM_KIND) return 1;
+
+  Tile el = kind_tile(kind);
+  int end = (pos == 'R') ? field_back(field).right : field_front(field).left;
+  if(end == 0 && el.left != el.right)
+    return 2;
+
+  return 1;
+}
+
+static int list_moves(Field const* field, Hand const* hand, Move* moves) {
+  char const* sides = (field->tiles->size == 0) ? "S" : (symmetric_field(field) ? "R" : "RL");
+  int count = 0;
+
+  for(int p=0; sides[p] != '\0'; p++) {
+    uint64_t playable = playable_kinds(field, hand, sides[p]);
+
+    for(uint64_t kinds = playable; kinds != 0; kinds &= kinds-1) {
+      int k = __builtin_ctzll(kinds);
+      int c = canonical_kind(k);
+      if(c != k && (playable & (1ULL << c)))
+        continue;
+
+      int n = orientations(field, k, sides[p]);
+
+      for(int o=0; o<n; o++) {
+        moves[count].kind = k;
+        moves[count].pos = sides[p];
+        moves[count].flip = (o == 1);
+        count++;
+      }
+    }
+  }
+
+  return count;
+}
+
+static void update_best(Search* s, int total) {
+  int best = atomic_load_explicit(s->best, memory_order_relaxed);
+
+  while(total > best && !atomic_compare_exchange_weak(s->best, &best, total))
+    ;
+}
+
+static void record_line(Search* s, int total) {
+  Line* l = s->line;
+  if(l == NULL || total <= atomic_load_explicit(&l->total, memory_order_relaxed)) return;
+
+  pthread_mutex_lock(&l->lock);
+  if(total > atomic_load(&l->total)) {
+    memcpy(l->moves, s->path, sizeof(Move) * s->depth);
+    l->length = s->depth;
+    atomic_store(&l->total, total);
+  }
+  pthread_mutex_unlock(&l->lock);
+}
+
+static int greedy_rollout(Search* s) {
+  Move chosen;
+  int gain = greedy_move(s->field, s->hand, &chosen);
+  Undo u;
+
+  if(gain < 0) {
+    update_best(s, s->field->total);
+    record_line(s, s->field->total);
+    return 0;
+  }
+
+  //anche le posizioni della partita greedy contano per il budget
+  s->nodes++;
+  out_of_budget(s);
+
+  make_move(s->field, s->hand, chosen.kind, chosen.pos, chosen.flip, &u);
+  s->path[s->depth++] = chosen;
+  int total = gain + greedy_rollout(s);
+  s->depth--;
+  unmake_move(s->field, s->hand, &u);
+
+  return total;
+}
+
+static long long monotonic_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+static long long monotonic_ms(void) {
+  return monotonic_us()/1000;
+}
+
+static bool out_of_budget(Search* s) {
+  if(s->progress != NULL && (s->nodes & (BUDGET_CHECK-1)) == 0)
+    atomic_fetch_add_explicit(&s->progress->nodes, BUDGET_CHECK, memory_order_relaxed);
+
+  Budget* b = s->budget;
+  if(b == NULL) return false;
+
+  if((s->nodes & (BUDGET_CHECK-1)) == 0) {
+    uint64_t nodes = atomic_fetch_add(&b->nodes, BUDGET_CHECK) + BUDGET_CHECK;
+    if((b->max_nodes > 0 && nodes >= b->max_nodes) || (b->deadline > 0 && monotonic_ms() >= b->deadline))
+      atomic_store(&b->stop, true);
+  }
+
+  return atomic_load_explicit(&b->stop, memory_order_relaxed);
+}
+
+/**
+ * @brief Funzione ausiliaria che calcola ricorsivamente il massimo punteggio aggiuntivo ottenibile dallo stato attuale.
+ * Ogni mossa viene applicata con make_move e annullata con unmake_move prima di provare la successiva, e il risultato
+ * di ogni posizione viene memorizzato nella tabella delle trasposizioni. Un ramo viene scartato quando il suo limite
+ * superiore non supera need né, se s->use_best è true, il miglior punteggio totale trovato finora.
+ * Le posizioni a s->limit mosse dalla radice vengono completate con greedy_rollout.
+ * Il valore restituito è sempre ottenibile, e se supera need e nessuna posizione è stata completata con greedy_rollout
+ * è il massimo esatto. Se il budget si esaurisce la ricerca si interrompe senza aggiornare la tabella delle trasposizioni
+ * @param s stato della ricerca
+ * @param need punteggio aggiuntivo che il chiamante deve superare perché il ramo sia interessante
+ * @param upper puntatore in cui viene scritto un limite superiore al punteggio aggiuntivo ottenibile
+ * @return Il punteggio aggiuntivo ottenibile
+*/
+static int recursive_mode_aux(Search* s, int need, int* upper) {
+  Field* field = s->field;
+  Hand* hand = s->hand;
+
+  STAT(s->stats.possible_moves_calls++);
+  if(!possible_moves(field, hand)) {
+    STAT(s->stats.leaves++);
+    update_best(s, field->total);
+    record_line(s, s->field->total);
+    *upper = 0;
+    return 0;
+  }
+
+  s->nodes++;
+  STAT(s->stats.depth_nodes[s->depth < STATS_DEPTHS ? s->depth : STATS_DEPTHS-1]++, stats_tick(s));
+  if(out_of_budget(s)) {
+    *upper = upper_bound(field, hand);
+    return 0;
+  }
+
+  //il ramo va esplorato solo se può superare sia need che il miglior punteggio trovato finora
+  int bound = upper_bound(field, hand);
+  if(s->use_best) {
+    int best = atomic_load_explicit(s->best, memory_order_relaxed);
+    if(best - field->total > need)
+      need = best - field->total;
+  }
+  if(bound <= need) {
+    s->cutoffs++;
+    *upper = bound;
+    return 0;
+  }
+
+  //con poche tessere in mano il punteggio si legge dalla tablebase, tranne quando migliora la partita da registrare
+  int exact;
+  if(s->tb != NULL && tablebase_probe(s->tb, field, hand, &exact) &&
+     (s->line == NULL || field->total + exact <= atomic_load_explicit(&s->line->total, memory_order_relaxed))) {
+    STAT(s->stats.tb_hits++);
+    update_best(s, field->total + exact);
+    *upper = exact;
+    return exact;
+  }
+
+  uint64_t key = position_key(s);
+  int max_points = 0;
+  int max_upper = 0;
+  int lo, hi;
+
+  if(tt_probe(s->tt, key, &lo, &hi)) {
+    STAT(s->stats.tt_hits++);
+    if(lo == hi || hi <= need) {
+      *upper = hi;
+      return lo;
+    }
+    max_points = lo;
+    if(hi < bound)
+      bound = hi;
+  }
+
+  //senza tessere speciali in mano il resto della partita è una scia del multigrafo dei valori, calcolata in modo esatto
+  if(s->graph && (hand->present >> SUM_KIND) == 0) {
+    int value = trail_value(field, hand, NULL, NULL, NULL);
+    if(s->line != NULL && field->total + value > atomic_load_explicit(&s->line->total, memory_order_relaxed)) {
+      int n;
+      trail_value(field, hand, s->trail, &s->path[s->depth], &n);
+      s->depth += n;
+      record_line(s, field->total + value);
+      s->depth -= n;
+    }
+
+    update_best(s, field->total + value);
+    tt_store(s->tt, key, value, value, hand->size);
+    *upper = value;
+    return value;
+  }
+
+  //oltre il limite dell'iterazione la partita viene completata con mosse greedy: il limite superiore resta bound
+  if(s->depth >= s->limit) {
+    s->horizons++;
+    int rollout = greedy_rollout(s);
+    *upper = bound;
+    return rollout > max_points ? rollout : max_points;
+  }
+
+  Move moves[MAX_MOVES];
+  int n_moves = list_moves(field, hand, moves);
+  Undo u;
+  STAT(s->stats.list_moves_calls++);
+
+  for(int i=0; i<n_moves; i++) {
+    STAT(if(moves[i].kind >= SUM_KIND) s->stats.special_plays[moves[i].kind - SUM_KIND]++);
+    make_move(field, hand, moves[i].kind, moves[i].pos, moves[i].flip, &u);
+    s->hand_key -= kind_key(moves[i].kind);
+    s->path[s->depth++] = moves[i];
+
+    int gain = move_gain(field, &u);
+    int child_need = (max_points > need ? max_points : need) - gain;
+    int child_upper;
+    int this_points = gain + recursive_mode_aux(s, child_need, &child_upper);
+
+    if(this_points > max_points)
+      max_points = this_points;
+    if(gain + child_upper > max_upper)
+      max_upper = gain + child_upper;
+
+    s->depth--;
+    s->hand_key += kind_key(moves[i].kind);
+    unmake_move(field, hand, &u);
+
+    if(s->budget != NULL && atomic_load_explicit(&s->budget->stop, memory_order_relaxed)) {
+      *upper = bound;
+      return max_points;
+    }
+  }
+
+  update_best(s, field->total + max_points);
+
+  if(max_upper < max_points)
+    max_upper = max_points;
+  if(max_upper > bound)
+    max_upper = bound;
+
+  tt_store(s->tt, key, max_points, max_upper, hand->size);
+  *upper = max_upper;
+  return max_points;
+}
+
+static bool best_move(Search* s, int* target, Move* move, Undo* u) {
+  Field* field = s->field;
+  Hand* hand = s->hand;
+
+  if(!possible_moves(field, hand))
+    return false;
+
+  Move list[MAX_MOVES];
+  int n_moves = list_moves(field, hand, list);
+
+  for(int i=0; i<n_moves; i++) {
+    make_move(field, hand, list[i].kind, list[i].pos, list[i].flip, u);
+    s->hand_key -= kind_key(list[i].kind);
+
+    //basta sapere se il ramo raggiunge il target: tutto ciò che non lo raggiunge può essere scartato
+    int gain = move_gain(field, u);
+    int child_upper;
+    if(gain <= *target && gain + recursive_mode_aux(s, *target - gain - 1, &child_upper) == *target) {
+      *target -= gain;
+      *move = list[i];
+      return true;
+    }
+
+    s->hand_key += kind_key(list[i].kind);
+    unmake_move(field, hand, u);
+  }
+
+  return false;
+}
+
+static int points(Field const* field) {
+  return field->total;
+}
+
+
+/*
+Funzioni per il motore a grafo
+*/
+
+/**
+ * @brief Funzione ausiliaria che restituisce il vertice del multigrafo dei valori corrispondente ad un estremo del campo
+ * @param v valore dell'estremo
+ * @return Il vertice (1-6), GRAPH_DEAD se nessuna tessera normale può essere accostata, -1 per un estremo [0|0]
+*/
+static int graph_vertex(int v) {
+  if(v == 0) return -1;
+
+  return (v >= 1 && v <= 6) ? v : GRAPH_DEAD;
+}
+
+/**
+ * @brief Funzione ausiliaria che restituisce il rappresentante della componente di un vertice, comprimendo il cammino
+ * @param parent array dei padri della union-find
+ * @param v vertice
+ * @return Il rappresentante della componente
+*/
+static int graph_find(int* parent, int v) {
+  while(parent[v] != v) {
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
+
+  return v;
+}
+
+/**
+ * @brief Funzione ausiliaria che trasforma un cammino del multigrafo in mosse su un lato del campo, scegliendo per ogni
+ * arco un tipo di tessera ancora disponibile in count
+ * @param walk vertici del cammino, letti a passi di step
+ * @param step 1 o -1
+ * @param length numero di vertici del cammino
+ * @param pos lato del campo ('L' o 'R')
+ * @param free_end true se l'estremo di partenza è [0|0] e la prima tessera va quindi orientata
+ * @param count tessere normali ancora disponibili per tipo, aggiornato
+ * @param moves array in cui vengono scritte le mosse
+ * @return Il numero di mosse scritte
+*/
+static int graph_emit(uint8_t const* walk, int step, int length, char pos, bool free_end, int* count, Move* moves) {
+  int n = 0;
+
+  for(int i=0; i+1<length; i++) {
+    int near = walk[i*step];
+    int far = walk[(i+1)*step];
+
+    //a destra la metà vicina è quella sinistra, a sinistra quella destra
+    int straight = (pos == 'R') ? (near-1)*6 + (far-1) : (far-1)*6 + (near-1);
+    int reversed = (pos == 'R') ? (far-1)*6 + (near-1) : (near-1)*6 + (far-1);
+    bool flip = count[straight] == 0;
+
+    moves[n].kind = flip ? reversed : straight;
+    moves[n].pos = pos;
+    //agli estremi diversi da [0|0] make_move gira la tessera da solo
+    moves[n].flip = flip && free_end && i == 0;
+    count[moves[n].kind]--;
+    n++;
+  }
+
+  return n;
+}
+
+static int trail_value(Field const* field, Hand const* hand, uint8_t* scratch, Move* moves, int* n_moves) {
+  int mult[7][7] = {{0}};
+  int loops[7] = {0};
+  int types[15][2];
+  int n_types = 0;
+  int all = 0;
+
+  //il multigrafo ha un vertice per valore e un arco per tessera, senza distinguere [a|b] da [b|a]
+  for(int k=0; k<SUM_KIND; k++) {
+    int a = k/6 + 1;
+    int b = k%6 + 1;
+    if(a > b) {
+      int tmp = a;
+      a = b;
+      b = tmp;
+    }
+    mult[a][b] += hand->count[k];
+  }
+
+  for(int a=1; a<=6; a++) {
+    loops[a] = mult[a][a] * 2*a;
+    all += loops[a];
+    for(int b=a+1; b<=6; b++) {
+      if(mult[a][b] == 0) continue;
+      types[n_types][0] = a;
+      types[n_types][1] = b;
+      n_types++;
+      all += mult[a][b] * (a+b);
+    }
+  }
+
+  //il campo è un arco virtuale tra i suoi estremi: un estremo [0|0] può diventare qualsiasi vertice, o restare libero
+  int ends[2][7];
+  int n_ends[2];
+  int values[2] = {field_front(field).left, field_back(field).right};
+  for(int side=0; side<2; side++) {
+    int v = graph_vertex(values[side]);
+    n_ends[side] = 0;
+    if(v >= 0) {
+      ends[side][n_ends[side]++] = v;
+    } else {
+      for(int x=0; x<=6; x++)
+        ends[side][n_ends[side]++] = x;
+    }
+  }
+
+  int best = -1;
+  uint32_t best_mask = 0;
+  int best_x = GRAPH_DEAD, best_y = GRAPH_DEAD, best_odd = 0;
+
+  //una scia ottima usa ogni tipo di arco m o m-1 volte: con meno copie si potrebbe aggiungere un'andata e ritorno
+  for(uint32_t mask=0; mask < (1u << n_types); mask++) {
+    int removed = 0;
+    for(int t=0; t<n_types; t++)
+      if(mask & (1u << t))
+        removed += types[t][0] + types[t][1];
+    if(all - removed <= best) continue;
+
+    int parent[7];
+    int weight[7] = {0};
+    int members[7] = {0};
+    int odd = 0;
+    for(int v=0; v<=6; v++)
+      parent[v] = v;
+
+    for(int t=0; t<n_types; t++) {
+      int a = types[t][0], b = types[t][1];
+      int used = mult[a][b] - (int)((mask >> t) & 1);
+      if(used > 0)
+        parent[graph_find(parent, a)] = graph_find(parent, b);
+      if(used & 1)
+        odd ^= (1 << a) | (1 << b);
+    }
+
+    for(int v=0; v<=6; v++) {
+      int r = graph_find(parent, v);
+      members[r] |= 1 << v;
+      weight[r] += loops[v];
+    }
+    for(int t=0; t<n_types; t++) {
+      int a = types[t][0], b = types[t][1];
+      weight[graph_find(parent, a)] += (mult[a][b] - (int)((mask >> t) & 1)) * (a+b);
+    }
+
+    //l'arco virtuale unisce le componenti dei due estremi, che devono avere al più due vertici dispari
+    for(int i=0; i<n_ends[0]; i++) {
+      for(int j=0; j<n_ends[1]; j++) {
+        int x = ends[0][i], y = ends[1][j];
+        int rx = graph_find(parent, x), ry = graph_find(parent, y);
+        int w = weight[rx];
+        int o = odd & members[rx];
+        if(ry != rx) {
+          w += weight[ry];
+          o |= odd & members[ry];
+        }
+        o ^= (1 << x) ^ (1 << y);
+
+        if(__builtin_popcount(o) <= 2 && w > best) {
+          best = w;
+          best_mask = mask;
+          best_x = x;
+          best_y = y;
+          best_odd = o;
+        }
+      }
+    }
+  }
+
+  if(moves == NULL) return best;
+
+  //Costruzione della scia con Hierholzer: il vertice GRAPH_SPLIT divide l'arco virtuale nelle due estensioni del campo
+  int c[8][8] = {{0}};
+  for(int t=0; t<n_types; t++) {
+    int a = types[t][0], b = types[t][1];
+    c[a][b] = c[b][a] = mult[a][b] - (int)((best_mask >> t) & 1);
+  }
+  for(int v=1; v<=6; v++)
+    c[v][v] = mult[v][v];
+  c[best_x][GRAPH_SPLIT]++;
+  c[GRAPH_SPLIT][best_x]++;
+  c[best_y][GRAPH_SPLIT]++;
+  c[GRAPH_SPLIT][best_y]++;
+
+  //la scia viene costruita durante la ricerca, quindi senza allocazioni: i vertici (0-7) stanno in un byte
+  uint8_t* stack = scratch;
+  uint8_t* trail = &scratch[hand->size+3];
+
+  int top = 0, length = 0;
+  stack[top++] = best_odd != 0 ? __builtin_ctz(best_odd) : best_y;
+  while(top > 0) {
+    int v = stack[top-1];
+    int w = 0;
+    while(w < 8 && c[v][w] == 0)
+      w++;
+
+    if(w < 8) {
+      c[v][w]--;
+      if(w != v)
+        c[w][v]--;
+      stack[top++] = w;
+    } else {
+      trail[length++] = v;
+      top--;
+    }
+  }
+
+  int split = 0;
+  while(trail[split] != GRAPH_SPLIT)
+    split++;
+
+  int count[SUM_KIND];
+  for(int k=0; k<SUM_KIND; k++)
+    count[k] = hand->count[k];
+
+  //la parte prima di GRAPH_SPLIT va percorsa all'indietro a partire dal vertice adiacente
+  char before = (trail[split-1] == best_x) ? 'L' : 'R';
+  char after = (before == 'L') ? 'R' : 'L';
+  int n = graph_emit(&trail[split-1], -1, split, before, values[before == 'L' ? 0 : 1] == 0, count, moves);
+  n += graph_emit(&trail[split+1], 1, length-split-1, after, values[after == 'L' ? 0 : 1] == 0, count, &moves[n]);
+  *n_moves = n;
+
+  return best;
+}
+
+
+/*
+Funzioni per il motore a fascio
+*/
+
+static int beam_eval(Field const* field, Hand const* hand) {
+  uint64_t specials = (1ULL << SUM_KIND) | (1ULL << ANY_KIND) | (1ULL << MIRROR_KIND);
+
+  //senza tessere speciali il resto della partita è una scia del multigrafo dei valori, calcolata esattamente finché
+  //i tipi di tessera sono pochi: trail_value prova due scelte per tipo
+  if(field->tiles->size > 0 && (hand->present & specials) == 0 && __builtin_popcountll(hand->present) <= BEAM_TRAIL_KINDS)
+    return field->total + trail_value(field, hand, NULL, NULL, NULL);
+
+  int flexibility = 0;
+  if(field->tiles->size > 0)
+    flexibility = __builtin_popcountll(playable_kinds(field, hand, 'L') | playable_kinds(field, hand, 'R'));
+
+  return field->total + upper_bound(field, hand) + flexibility;
+}
+
+/**
+ * @brief Funzione ausiliaria che confronta due BeamCandidate per qsort: prima la valutazione più alta, poi a parità
+ * la posizione di partenza e la mossa, così che la scelta non dipenda dall'implementazione di qsort
+ * @param a primo BeamCandidate
+ * @param b secondo BeamCandidate
+ * @return Un valore negativo se a va prima di b, positivo se dopo
+*/
+static int cmp_beam_candidate(void const* a, void const* b) {
+  BeamCandidate const* x = (BeamCandidate const*)a;
+  BeamCandidate const* y = (BeamCandidate const*)b;
+
+  if(x->eval != y->eval)
+    return (x->eval > y->eval) ? -1 : 1;
+  if(x->parent != y->parent)
+    return (x->parent < y->parent) ? -1 : 1;
+  if(x->move.kind != y->move.kind)
+    return (x->move.kind < y->move.kind) ? -1 : 1;
+  if(x->move.pos != y->move.pos)
+    return (x->move.pos < y->move.pos) ? -1 : 1;
+  return (int)x->move.flip - (int)y->move.flip;
+}
+
+static bool beam_search(Field* field, Hand* hand, int width, Result* result) {
+  if(width < 1)
+    width = 1;
+
+  //le posizioni di una mossa vivono in una delle due Arena, che viene svuotata due mosse dopo
+  Arena arenas[2];
+  bool ok = move_stack_init(&result->line, hand->size);
+  ok = arena_init(&arenas[0], ARENA_BLOCK_SIZE) && ok;
+  ok = arena_init(&arenas[1], ARENA_BLOCK_SIZE) && ok;
+
+  size_t buckets = 1;
+  while(buckets < (size_t)width * 4)
+    buckets <<= 1;
+
+  BeamNode* nodes = (BeamNode*)malloc(sizeof(BeamNode) * width);
+  BeamNode* next = (BeamNode*)malloc(sizeof(BeamNode) * width);
+  BeamCandidate* candidates = (BeamCandidate*)malloc(sizeof(BeamCandidate) * width * MAX_MOVES);
+  uint64_t* seen = (uint64_t*)malloc(sizeof(uint64_t) * buckets);
+  size_t steps_capacity = (size_t)width * (hand->size + 1);
+  BeamStep* steps = (BeamStep*)malloc(sizeof(BeamStep) * steps_capacity);
+  Undo* played = (Undo*)malloc(sizeof(Undo) * (hand->size + 1));
+  Move* line = (Move*)malloc(sizeof(Move) * (hand->size + 1));
+  ok = ok && nodes != NULL && next != NULL && candidates != NULL && seen != NULL && steps != NULL && played != NULL &&
+       line != NULL;
+  if(ok) {
+    nodes[0].field = create_field_in(&arenas[0]);
+    ok = nodes[0].field != NULL && reserve_deque(nodes[0].field->tiles, field->tiles->size + hand->size + 1) &&
+         copy_field(field, nodes[0].field);
+  }
+  int n_nodes = 0;
+  if(ok) {
+    nodes[0].hand = *hand;
+    nodes[0].hand_key = hand_key(hand);
+    nodes[0].total = field->total;
+    nodes[0].step = -1;
+    n_nodes = 1;
+  }
+  int n_steps = 0;
+  int best_total = field->total;
+  int best_step = -1;
+  uint64_t evaluated = 0;
+  int level = 0;
+
+  while(n_nodes > 0) {
+    Move moves[MAX_MOVES];
+    Undo u;
+    int n_candidates = 0;
+
+    //ogni mossa viene applicata alla posizione di partenza solo per valutarla, poi annullata
+    for(int i=0; i<n_nodes; i++) {
+      BeamNode* node = &nodes[i];
+      int n_moves = list_moves(node->field, &node->hand, moves);
+
+      if(n_moves == 0 && node->total > best_total) {
+        best_total = node->total;
+        best_step = node->step;
+      }
+
+      for(int j=0; j<n_moves; j++) {
+        BeamCandidate* c = &candidates[n_candidates++];
+        make_move(node->field, &node->hand, moves[j].kind, moves[j].pos, moves[j].flip, &u);
+        c->parent = i;
+        c->move = moves[j];
+        c->eval = beam_eval(node->field, &node->hand);
+        c->key = field_key(node->field, node->hand_key - kind_key(moves[j].kind));
+        unmake_move(node->field, &node->hand, &u);
+      }
+    }
+    evaluated += n_candidates;
+    if(n_candidates == 0) break;
+
+    qsort(candidates, n_candidates, sizeof(BeamCandidate), cmp_beam_candidate);
+    memset(seen, 0, sizeof(uint64_t) * buckets);
+
+    //le posizioni raggiunte con le stesse tessere in ordine diverso vengono tenute una volta sola, con la valutazione migliore
+    Arena* arena = &arenas[(level+1) & 1];
+    arena_reset(arena);
+    int n_next = 0;
+    for(int i=0; i<n_candidates && n_next<width; i++) {
+      BeamCandidate const* c = &candidates[i];
+      size_t b = c->key & (buckets-1);
+      while(seen[b] != 0 && seen[b] != c->key)
+        b = (b+1) & (buckets-1);
+      if(seen[b] == c->key) continue;
+      seen[b] = c->key;
+
+      BeamNode const* parent = &nodes[c->parent];
+      BeamNode* child = &next[n_next];
+      child->field = create_field_in(arena);
+      //senza memoria per altre posizioni il fascio si restringe a quelle già copiate, e la ricerca fallisce solo se è vuoto
+      if(child->field == NULL || !copy_field(parent->field, child->field)) {
+        ok = n_next > 0;
+        break;
+      }
+      n_next++;
+      child->hand = parent->hand;
+      make_move(child->field, &child->hand, c->move.kind, c->move.pos, c->move.flip, &u);
+      child->hand_key = parent->hand_key - kind_key(c->move.kind);
+      child->total = child->field->total;
+      child->step = n_steps;
+
+      steps[n_steps].prev = parent->step;
+      steps[n_steps].move = c->move;
+      n_steps++;
+    }
+
+    BeamNode* t = nodes;
+    nodes = next;
+    next = t;
+    n_nodes = ok ? n_next : 0;
+    level++;
+  }
+
+  //la partita migliore viene ricostruita risalendo la storia delle mosse e giocata sul campo per registrarla
+  if(ok) {
+    int length = 0;
+    for(int i=best_step; i>=0; i=steps[i].prev)
+      line[length++] = steps[i].move;
+
+    for(int i=0; i<length; i++) {
+      Move const* m = &line[length-1-i];
+      make_move(field, hand, m->kind, m->pos, m->flip, &played[i]);
+      move_stack_push(&result->line, field, m);
+    }
+
+    result->total = points(field);
+    result->nodes = evaluated;
+    result->cutoffs = 0;
+    result->proven = false;
+    result->optimum = -1;
+    STAT(stats_init(&result->stats, 0, NULL));
+
+    for(int i=length-1; i>=0; i--)
+      unmake_move(field, hand, &played[i]);
+  } else {
+    move_stack_free(&result->line);
+  }
+
+  free(nodes);
+  free(next);
+  free(candidates);
+  free(seen);
+  free(steps);
+  free(played);
+  free(line);
+  arena_free(&arenas[0]);
+  arena_free(&arenas[1]);
+  return ok;
+}
+
+
+/*
+Funzioni per la tablebase
+*/
+
+/**
+ * @brief Funzione ausiliaria che restituisce la classe di un tipo di tessera nella tablebase
+ * @param kind tipo della tessera
+ * @return La classe: da 0 a 20 le tessere normali [a|b] con a <= b, poi [0|0], [11|11] e [12|21]
+*/
+static int tablebase_class(int kind) {
+  if(kind == ANY_KIND) return 21;
+  if(kind == SUM_KIND) return 22;
+  if(kind == MIRROR_KIND) return 23;
+
+  int c = canonical_kind(kind);
+  int a = c / 6;
+  return a*6 - a*(a-1)/2 + (c%6 - a);
+}
+
+/**
+ * @brief Funzione ausiliaria che restituisce il tipo canonico di una classe della tablebase
+ * @param c classe
+ * @return Il tipo della tessera
+*/
+static int tablebase_kind(int c) {
+  if(c == 21) return ANY_KIND;
+  if(c == 22) return SUM_KIND;
+  if(c == 23) return MIRROR_KIND;
+
+  int a = 0;
+  while(c >= 6 - a) {
+    c -= 6 - a;
+    a++;
+  }
+  return a*6 + a + c;
+}
+
+static void tablebase_init(Tablebase* tb, int tiles) {
+  tb->values = NULL;
+  tb->map = NULL;
+  tb->map_size = 0;
+  tb->tiles = tiles;
+
+  for(int n=0; n<=TABLEBASE_CLASSES+TABLEBASE_MAX_TILES; n++)
+    for(int k=0; k<=TABLEBASE_MAX_TILES; k++)
+      tb->binom[n][k] = (k == 0) ? 1 : (n == 0) ? 0 : tb->binom[n-1][k-1] + tb->binom[n-1][k];
+
+  //le mani di m tessere sono C(24+m-1, m), di cui C(22+m-1, m) senza [11|11] e [12|21]
+  tb->offset[0] = 0;
+  for(int m=0; m<=TABLEBASE_MAX_TILES; m++) {
+    size_t hands = tb->binom[TABLEBASE_CLASSES+m-1][m];
+    tb->plain[m] = tb->binom[TABLEBASE_PLAIN_CLASSES+m-1][m];
+    tb->offset[m+1] = tb->offset[m] + tb->plain[m]*TABLEBASE_OUTER + (hands - tb->plain[m])*TABLEBASE_ENDS;
+  }
+}
+
+static size_t tablebase_rank(Tablebase const* tb, Hand const* hand) {
+  uint8_t count[TABLEBASE_CLASSES] = {0};
+  for(uint64_t m = hand->present; m != 0; m &= m-1) {
+    int k = __builtin_ctzll(m);
+    count[tablebase_class(k)] += hand->count[k];
+  }
+
+  //la mano ordinata c_1 <= ... <= c_m corrisponde alla combinazione senza ripetizioni d_i = c_i + i - 1 e ha rango
+  //somma di C(d_i, i): le mani con tutte le classi minori di TABLEBASE_PLAIN_CLASSES hanno i ranghi più bassi
+  size_t rank = 0;
+  int i = 1;
+  for(int c=0; c<TABLEBASE_CLASSES; c++)
+    for(int j=0; j<count[c]; j++, i++)
+      rank += tb->binom[c+i-1][i];
+
+  return rank;
+}
+
+static size_t tablebase_block(Tablebase const* tb, int m, size_t rank) {
+  if(rank < tb->plain[m])
+    return tb->offset[m] + rank*TABLEBASE_OUTER;
+
+  return tb->offset[m] + tb->plain[m]*TABLEBASE_OUTER + (rank - tb->plain[m])*TABLEBASE_ENDS;
+}
+
+/**
+ * @brief Funzione ausiliaria che costruisce la mano di m tessere con il rango fornito tra quelle della stessa dimensione
+ * @param tb Tablebase
+ * @param m numero di tessere
+ * @param rank rango della mano
+ * @param hand Hand in cui viene scritta la mano
+*/
+static void tablebase_unrank(Tablebase const* tb, int m, size_t rank, Hand* hand) {
+  hand_init(hand);
+  int d = TABLEBASE_CLASSES + m - 1;
+
+  for(int i=m; i>=1; i--) {
+    do d--; while(tb->binom[d][i] > rank);
+    rank -= tb->binom[d][i];
+    hand_add(hand, tablebase_kind(d - (i-1)));
+  }
+}
+
+static bool tablebase_probe(Tablebase const* tb, Field const* field, Hand const* hand, int* value) {
+  if((int)hand->size > tb->tiles || field->tiles->size == 0) return false;
+
+  Tile first = field_front(field);
+  Tile last = field_back(field);
+  if((unsigned)first.left >= TABLEBASE_VALUES || (unsigned)last.right >= TABLEBASE_VALUES)
+    return false;
+
+  //i valori interni contano solo per [11|11] e [12|21], che copiano la tessera adiacente
+  size_t ends = first.left*TABLEBASE_VALUES + last.right;
+  if(hand->count[SUM_KIND] > 0 || hand->count[MIRROR_KIND] > 0) {
+    if((unsigned)first.right >= TABLEBASE_VALUES || (unsigned)last.left >= TABLEBASE_VALUES)
+      return false;
+    ends = ((first.left*TABLEBASE_VALUES + first.right)*TABLEBASE_VALUES + last.left)*TABLEBASE_VALUES + last.right;
+  }
+
+  size_t block = tablebase_block(tb, (int)hand->size, tablebase_rank(tb, hand));
+  *value = tb->values[block + ends] + 2*(int)field->tiles->size*hand->count[SUM_KIND];
+  return true;
+}
+
+static int tablebase_load(Tablebase* tb, char const* path) {
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if(fd < 0 || fstat(fd, &st) != 0) {
+    if(fd >= 0)
+      close(fd);
+    return DOMINO_ERR_IO;
+  }
+
+  void* map = (st.st_size >= TABLEBASE_HEADER_SIZE) ? mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+  close(fd);
+
+  uint8_t const* header = (uint8_t const*)map;
+  uint32_t tiles = 0;
+  if(map != MAP_FAILED)
+    memcpy(&tiles, header + 8, sizeof(tiles));
+  if(map != MAP_FAILED && (memcmp(header, TABLEBASE_MAGIC, 8) != 0 || tiles > TABLEBASE_MAX_TILES)) {
+    munmap(map, (size_t)st.st_size);
+    map = MAP_FAILED;
+  }
+  if(map == MAP_FAILED)
+    return DOMINO_ERR_BAD_FILE;
+
+  tablebase_init(tb, (int)tiles);
+  if((size_t)st.st_size != TABLEBASE_HEADER_SIZE + tb->offset[tiles+1]) {
+    munmap(map, (size_t)st.st_size);
+    return DOMINO_ERR_BAD_FILE;
+  }
+
+  tb->map = map;
+  tb->map_size = (size_t)st.st_size;
+  tb->values = (uint8_t*)header + TABLEBASE_HEADER_SIZE;
+  return DOMINO_OK;
+}
+
+static void tablebase_free(Tablebase* tb) {
+  if(tb->map != NULL)
+    munmap(tb->map, tb->map_size);
+  else
+    free(tb->values);
+  tb->values = NULL;
+  tb->map = NULL;
+}
+
+/**
+ * @brief Funzione ausiliaria che calcola il punteggio ottimo ancora realizzabile durante la generazione, leggendo dalla
+ * tablebase le posizioni già calcolate. Dopo una [11|11] gli estremi possono superare 6: quelle posizioni vengono
+ * risolte esplorando tutte le mosse
+ * @param tb Tablebase in generazione
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @return Il punteggio ottimo
+*/
+static int tablebase_search(Tablebase const* tb, Field* field, Hand* hand) {
+  int value;
+  if(tablebase_probe(tb, field, hand, &value))
+    return value;
+
+  Move moves[MAX_MOVES];
+  int n_moves = list_moves(field, hand, moves);
+  int best = 0;
+  Undo u;
+
+  for(int i=0; i<n_moves; i++) {
+    make_move(field, hand, moves[i].kind, moves[i].pos, moves[i].flip, &u);
+    value = move_gain(field, &u) + tablebase_search(tb, field, hand);
+    unmake_move(field, hand, &u);
+
+    if(value > best)
+      best = value;
+  }
+
+  return best;
+}
+
+static void* tablebase_worker(void* arg) {
+  TablebaseWorker* w = (TablebaseWorker*)arg;
+  TablebaseJob* job = w->job;
+  Tablebase* tb = job->tb;
+  Field* field = w->field;
+
+  while(true) {
+    size_t first = atomic_fetch_add(&job->next, TABLEBASE_CHUNK);
+    if(first >= job->count) break;
+    size_t last = (first + TABLEBASE_CHUNK < job->count) ? first + TABLEBASE_CHUNK : job->count;
+
+    for(size_t r=first; r<last; r++) {
+      Hand hand;
+      tablebase_unrank(tb, job->size, r, &hand);
+      uint8_t* values = tb->values + tablebase_block(tb, job->size, r);
+      bool plain = r < tb->plain[job->size];
+
+      for(int ends=0; ends<(plain ? TABLEBASE_OUTER : TABLEBASE_ENDS); ends++) {
+        Tile front, back;
+        if(plain) {
+          //i valori interni non vengono mai letti
+          front.left = front.right = ends / TABLEBASE_VALUES;
+          back.left = back.right = ends % TABLEBASE_VALUES;
+        } else {
+          front.left = ends / (TABLEBASE_VALUES*TABLEBASE_VALUES*TABLEBASE_VALUES);
+          front.right = ends / (TABLEBASE_VALUES*TABLEBASE_VALUES) % TABLEBASE_VALUES;
+          back.left = ends / TABLEBASE_VALUES % TABLEBASE_VALUES;
+          back.right = ends % TABLEBASE_VALUES;
+        }
+        field_push(field, 'R', front);
+        field_push(field, 'R', back);
+
+        int value = tablebase_search(tb, field, &hand) - 2*2*hand.count[SUM_KIND];
+        //con al più TABLEBASE_MAX_TILES tessere il valore sta sempre in un byte
+        assert(value >= 0 && value <= UINT8_MAX);
+        values[ends] = (uint8_t)value;
+
+        field_pop(field, 'R');
+        field_pop(field, 'R');
+      }
+    }
+  }
+
+  return NULL;
+}
+
+static int tablebase_generate(char const* path, int tiles, int threads, FILE* log) {
+  if(tiles < 0 || tiles > TABLEBASE_MAX_TILES || threads < 1)
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  Tablebase tb;
+  tablebase_init(&tb, -1);
+  size_t bytes = tb.offset[tiles+1];
+  tb.values = (uint8_t*)malloc(bytes);
+  TablebaseWorker* workers = (TablebaseWorker*)calloc(threads, sizeof(TablebaseWorker));
+  bool ok = tb.values != NULL && workers != NULL;
+
+  //ogni stato degli estremi è un campo con due tessere: con una sola tessera la prima e l'ultima coincidono,
+  //ma le mosse hanno gli stessi effetti
+  for(int i=0; ok && i<threads; i++) {
+    workers[i].field = create_field();
+    ok = workers[i].field != NULL && reserve_deque(workers[i].field->tiles, tiles + 3);
+  }
+  if(!ok) {
+    for(int i=0; workers != NULL && i<threads; i++)
+      free_field(workers[i].field);
+    free(workers);
+    free(tb.values);
+    return DOMINO_ERR_NO_MEMORY;
+  }
+
+  //le mani di m tessere usano solo quelle di m-1, già complete: tb.tiles impedisce di leggere quelle in calcolo
+  for(int m=0; m<=tiles; m++) {
+    TablebaseJob job;
+    job.tb = &tb;
+    job.size = m;
+    job.count = tb.binom[TABLEBASE_CLASSES+m-1][m];
+    atomic_init(&job.next, 0);
+
+    long long start = monotonic_ms();
+    for(int i=0; i<threads; i++) {
+      workers[i].job = &job;
+      pthread_create(&workers[i].thread, NULL, tablebase_worker, &workers[i]);
+    }
+    for(int i=0; i<threads; i++)
+      pthread_join(workers[i].thread, NULL);
+    tb.tiles = m;
+
+    if(log != NULL)
+      fprintf(log, "Tablebase: %d tiles, %zu hands, %lld ms\n", m, job.count, monotonic_ms() - start);
+  }
+
+  FILE* out = fopen(path, "wb");
+  uint8_t header[TABLEBASE_HEADER_SIZE] = {0};
+  uint32_t n = (uint32_t)tiles;
+  memcpy(header, TABLEBASE_MAGIC, 8);
+  memcpy(header + 8, &n, sizeof(n));
+  bool written = out != NULL && fwrite(header, 1, TABLEBASE_HEADER_SIZE, out) == TABLEBASE_HEADER_SIZE &&
+                 fwrite(tb.values, 1, bytes, out) == bytes;
+  if(out != NULL && fclose(out) != 0)
+    written = false;
+
+  free(workers);
+  tablebase_free(&tb);
+  return written ? DOMINO_OK : DOMINO_ERR_IO;
+}
+
+/*
+Funzioni per la ricerca parallela
+*/
+
+/**
+ * @brief Inserisce un Task in coda alla coda fornita
+ * @param q La coda da modificare
+ * @param t Il Task da inserire
+ * @return true se il Task è stato inserito, false se la coda è piena e la memoria non basta per ingrandirla
+*/
+static bool push_task(TaskDeque* q, Task const* t) {
+  pthread_mutex_lock(&q->lock);
+
+  if(q->tail == q->capacity) {
+    //prima di ingrandire l'array si recupera lo spazio liberato in testa
+    size_t size = q->tail - q->head;
+    if(q->head > 0) {
+      memmove(q->tasks, q->tasks + q->head, size*sizeof(Task));
+    } else {
+      Task* new_tasks = (Task*)realloc(q->tasks, sizeof(Task) * q->capacity*2);
+      if(new_tasks == NULL) {
+        pthread_mutex_unlock(&q->lock);
+        return false;
+      }
+      q->tasks = new_tasks;
+      q->capacity *= 2;
+    }
+    q->head = 0;
+    q->tail = size;
+  }
+
+  q->tasks[q->tail++] = *t;
+  pthread_mutex_unlock(&q->lock);
+  return true;
+}
+
+/**
+ * @brief Preleva un Task dalla coda fornita: il proprietario preleva l'ultimo inserito, gli altri thread il primo
+ * @param q La coda
+ * @param t Il Task in cui scrivere quello prelevato
+ * @param steal true se il Task viene rubato da un altro thread
+ * @return true se è stato prelevato un Task, false se la coda è vuota
+*/
+static bool pop_task(TaskDeque* q, Task* t, bool steal) {
+  bool found = false;
+
+  pthread_mutex_lock(&q->lock);
+  if(q->head < q->tail) {
+    *t = steal ? q->tasks[q->head++] : q->tasks[--q->tail];
+    found = true;
+  }
+  pthread_mutex_unlock(&q->lock);
+
+  return found;
+}
+
+/**
+ * @brief Esegue un Task: applica le sue mosse, poi divide il sotto-albero nei figli se è vicino alla radice e ci sono
+ * thread senza lavoro, altrimenti lo esplora con recursive_mode_aux. Un figlio che non entra nella coda viene
+ * eseguito subito dal thread stesso
+ * @param w Il thread che esegue il Task
+ * @param t Il Task da eseguire
+*/
+static void run_task(Worker* w, Task const* t) {
+  Search* s = &w->search;
+  Undo undo[SPLIT_DEPTH];
+
+  for(int i=0; i<t->length; i++) {
+    make_move(s->field, s->hand, t->moves[i].kind, t->moves[i].pos, t->moves[i].flip, &undo[i]);
+    s->hand_key -= kind_key(t->moves[i].kind);
+    s->path[s->depth++] = t->moves[i];
+  }
+
+  //un Task oltre il limite dell'iterazione non va diviso: recursive_mode_aux lo completa con mosse greedy
+  bool split = t->length == 0 || (t->length < SPLIT_DEPTH && t->length < s->limit && atomic_load(&w->pool->idle) > 0);
+
+  if(split) {
+    Move moves[MAX_MOVES];
+    int n_moves = list_moves(s->field, s->hand, moves);
+    Task child = *t;
+
+    update_best(s, s->field->total);
+    record_line(s, s->field->total);
+    child.length = t->length + 1;
+
+    atomic_fetch_add(&w->pool->pending, n_moves);
+    atomic_fetch_add(&w->pool->created, n_moves);
+    int queued = 0;
+    for(int i=0; i<n_moves; i++) {
+      child.moves[t->length] = moves[i];
+      if(push_task(&w->queue, &child)) {
+        queued++;
+        continue;
+      }
+
+      //il Task padre è ancora in corso, quindi pending non arriva a zero
+      run_task(w, &child);
+      atomic_fetch_add(&w->pool->done, 1);
+      atomic_fetch_sub(&w->pool->pending, 1);
+    }
+    atomic_fetch_add(&w->pool->queued, queued);
+
+    //queued va incrementato prima di leggere idle: un thread che si sta fermando vede i Task o riceve il segnale
+    if(atomic_load(&w->pool->idle) > 0) {
+      pthread_mutex_lock(&w->pool->lock);
+      pthread_cond_broadcast(&w->pool->wake);
+      pthread_mutex_unlock(&w->pool->lock);
+    }
+  } else {
+    int upper;
+    update_best(s, s->field->total + recursive_mode_aux(s, -1, &upper));
+  }
+
+  for(int i=t->length-1; i>=0; i--) {
+    s->depth--;
+    s->hand_key += kind_key(t->moves[i].kind);
+    unmake_move(s->field, s->hand, &undo[i]);
+  }
+}
+
+/**
+ * @brief Ciclo di un thread della ricerca parallela: esegue i Task della propria coda, poi prova a rubarli agli altri,
+ * finché tutti i Task creati non sono stati completati. Senza Task in coda il thread si ferma su pool->wake
+ * @param arg Il Worker del thread
+ * @return NULL
+*/
+static void* worker_loop(void* arg) {
+  Worker* w = (Worker*)arg;
+  Pool* pool = w->pool;
+  bool idle = false;
+  Task t;
+
+  while(true) {
+    bool found = pop_task(&w->queue, &t, false);
+
+    for(int i=1; i<pool->threads && !found; i++)
+      found = pop_task(&pool->workers[(w->id + i) % pool->threads].queue, &t, true);
+
+    if(found) {
+      atomic_fetch_sub(&pool->queued, 1);
+      if(idle) {
+        atomic_fetch_sub(&pool->idle, 1);
+        idle = false;
+      }
+      run_task(w, &t);
+      long done = atomic_fetch_add(&pool->done, 1) + 1;
+      if(w->search.progress != NULL) {
+        atomic_store(&w->search.progress->done, done);
+        atomic_store(&w->search.progress->total, atomic_load(&pool->created));
+      }
+
+      //chi completa l'ultimo Task sveglia gli altri thread, che possono terminare
+      if(atomic_fetch_sub(&pool->pending, 1) == 1) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+      }
+    } else {
+      if(!idle) {
+        atomic_fetch_add(&pool->idle, 1);
+        idle = true;
+      }
+
+      //le condizioni vengono rilette sotto il lock, quindi un segnale inviato dopo il controllo non va perso
+      pthread_mutex_lock(&pool->lock);
+      while(atomic_load(&pool->queued) == 0 && atomic_load(&pool->pending) > 0)
+        pthread_cond_wait(&pool->wake, &pool->lock);
+      bool finished = atomic_load(&pool->pending) == 0;
+      pthread_mutex_unlock(&pool->lock);
+      if(finished)
+        break;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Funzione ausiliaria che libera i primi n Worker della ricerca parallela
+ * @param pool Pool dei Worker
+ * @param n numero di Worker inizializzati
+*/
+static void _free_workers(Pool* pool, int n) {
+  for(int i=0; i<n; i++) {
+    Worker* w = &pool->workers[i];
+    free_field(w->search.field);
+    free(w->search.hand);
+    free(w->search.path);
+    free(w->search.trail);
+    free(w->queue.tasks);
+    pthread_mutex_destroy(&w->queue.lock);
+  }
+
+  free(pool->workers);
+}
+
+static bool parallel_search(Search* s, int threads) {
+  Pool pool;
+  pool.threads = threads;
+  pool.workers = (Worker*)malloc(sizeof(Worker) * threads);
+  if(pool.workers == NULL)
+    return false;
+
+  //tutta la memoria dei thread viene presa prima di avviarli, così una mancanza si risolve senza fermarli
+  bool ok = true;
+  int n = 0;
+  while(ok && n < threads) {
+    Worker* w = &pool.workers[n++];
+    w->pool = &pool;
+    w->id = n-1;
+    w->search = *s;
+    w->search.field = clone_field(s->field);
+    w->search.hand = (Hand*)malloc(sizeof(Hand));
+    w->search.path = (Move*)malloc(sizeof(Move) * (s->hand->size+1));
+    w->search.trail = (uint8_t*)malloc(2 * (s->hand->size+3));
+    w->search.nodes = 0;
+    w->search.cutoffs = 0;
+    w->search.horizons = 0;
+    STAT(stats_init(&w->search.stats, s->stats.interval_ms, s->stats.out), w->search.stats.start_ms = s->stats.start_ms);
+
+    pthread_mutex_init(&w->queue.lock, NULL);
+    w->queue.capacity = 64;
+    w->queue.head = 0;
+    w->queue.tail = 0;
+    w->queue.tasks = (Task*)malloc(sizeof(Task) * w->queue.capacity);
+
+    ok = w->search.field != NULL && w->search.hand != NULL && w->search.path != NULL && w->search.trail != NULL &&
+         w->queue.tasks != NULL;
+    if(ok)
+      *w->search.hand = *s->hand;
+  }
+  if(!ok) {
+    _free_workers(&pool, n);
+    return false;
+  }
+
+  atomic_init(&pool.pending, 1);
+  atomic_init(&pool.created, 1);
+  atomic_init(&pool.done, 0);
+  atomic_init(&pool.idle, 0);
+  atomic_init(&pool.queued, 1);
+  pthread_mutex_init(&pool.lock, NULL);
+  pthread_cond_init(&pool.wake, NULL);
+
+  //il Task radice viene diviso subito nelle prime mosse; la coda è vuota, quindi l'inserimento non alloca
+  Task root;
+  root.length = 0;
+  push_task(&pool.workers[0].queue, &root);
+
+  for(int i=0; i<threads; i++)
+    pthread_create(&pool.workers[i].thread, NULL, worker_loop, &pool.workers[i]);
+
+  //il thread chiamante non partecipa alla ricerca: attende la fine dei thread, che aggiornano da soli l'avanzamento.
+  //Le code vanno liberate solo quando nessun thread può più rubarvi Task
+  for(int i=0; i<threads; i++)
+    pthread_join(pool.workers[i].thread, NULL);
+
+  for(int i=0; i<threads; i++) {
+    Worker* w = &pool.workers[i];
+    s->nodes += w->search.nodes;
+    s->cutoffs += w->search.cutoffs;
+    s->horizons += w->search.horizons;
+    STAT(stats_merge(&s->stats, &w->search.stats));
+  }
+
+  _free_workers(&pool, threads);
+  pthread_cond_destroy(&pool.wake);
+  pthread_mutex_destroy(&pool.lock);
+  return true;
+}
+
+#ifdef DOMINO_STATS
+static void stats_init(Stats* st, long interval_ms, FILE* out) {
+  memset(st, 0, sizeof(Stats));
+  st->interval_ms = (out != NULL) ? interval_ms : 0;
+  st->out = out;
+  st->start_ms = monotonic_ms();
+  st->next_snapshot = st->start_ms + interval_ms;
+}
+
+static void stats_merge(Stats* dest, Stats const* src) {
+  for(int d=0; d<STATS_DEPTHS; d++)
+    dest->depth_nodes[d] += src->depth_nodes[d];
+  for(int k=0; k<3; k++)
+    dest->special_plays[k] += src->special_plays[k];
+
+  dest->leaves += src->leaves;
+  dest->possible_moves_calls += src->possible_moves_calls;
+  dest->list_moves_calls += src->list_moves_calls;
+  dest->tt_hits += src->tt_hits;
+  dest->tb_hits += src->tb_hits;
+}
+
+static void stats_tick(Search* s) {
+  Stats* st = &s->stats;
+  if(st->interval_ms <= 0 || (s->nodes & (BUDGET_CHECK-1)) != 0) return;
+
+  long long now = monotonic_ms();
+  if(now < st->next_snapshot) return;
+
+  st->next_snapshot = now + st->interval_ms;
+  fprintf(st->out, "#snapshot elapsed_ms %lld nodes %llu leaves %llu tt_hits %llu depth %d\n", now - st->start_ms,
+          (unsigned long long)s->nodes, (unsigned long long)st->leaves, (unsigned long long)st->tt_hits, s->depth);
+}
+
+static void print_stats(FILE* out, Stats const* st, uint64_t nodes, uint64_t cutoffs) {
+  fprintf(out, "#stats\n");
+  fprintf(out, "elapsed_ms %lld\n", monotonic_ms() - st->start_ms);
+  fprintf(out, "nodes %llu\n", (unsigned long long)nodes);
+  fprintf(out, "cutoffs %llu\n", (unsigned long long)cutoffs);
+  fprintf(out, "leaves %llu\n", (unsigned long long)st->leaves);
+  fprintf(out, "tt_hits %llu\n", (unsigned long long)st->tt_hits);
+  fprintf(out, "tb_hits %llu\n", (unsigned long long)st->tb_hits);
+  fprintf(out, "possible_moves_calls %llu\n", (unsigned long long)st->possible_moves_calls);
+  fprintf(out, "list_moves_calls %llu\n", (unsigned long long)st->list_moves_calls);
+  fprintf(out, "special_plays sum %llu any %llu mirror %llu\n", (unsigned long long)st->special_plays[0],
+          (unsigned long long)st->special_plays[1], (unsigned long long)st->special_plays[2]);
+
+  int last = STATS_DEPTHS-1;
+  while(last > 0 && st->depth_nodes[last] == 0)
+    last--;
+  fprintf(out, "depth_nodes");
+  for(int d=0; d<=last; d++)
+    fprintf(out, " %llu", (unsigned long long)st->depth_nodes[d]);
+  fprintf(out, "\n");
+
+  for(int i=0; i<st->root_count; i++) {
+    Tile el = move_oriented(&st->root_moves[i]);
+    fprintf(out, "root_us %c %d %d %lld\n", st->root_moves[i].pos, el.left, el.right, st->root_us[i]);
+  }
+  fprintf(out, "#end\n");
+}
+#endif
+
+static void search_root(Search* s, int threads) {
+  //se la memoria non basta per i thread la ricerca prosegue in quello chiamante
+  if(threads > 1 && parallel_search(s, threads))
+    return;
+
+  Move moves[MAX_MOVES];
+  int n_moves = list_moves(s->field, s->hand, moves);
+  Undo u;
+
+  STAT(s->stats.root_count = n_moves, memcpy(s->stats.root_moves, moves, sizeof(Move) * n_moves));
+
+  if(s->progress != NULL)
+    atomic_store(&s->progress->total, n_moves);
+
+  for(int i=0; i<n_moves; i++) {
+    if(s->progress != NULL)
+      atomic_store(&s->progress->done, i);
+    STAT(s->stats.root_us[i] -= monotonic_us());
+
+    make_move(s->field, s->hand, moves[i].kind, moves[i].pos, moves[i].flip, &u);
+    s->hand_key -= kind_key(moves[i].kind);
+    s->path[s->depth++] = moves[i];
+
+    int upper;
+    update_best(s, s->field->total + recursive_mode_aux(s, -1, &upper));
+
+    //Riporta il campo e la mano allo stato iniziale
+    s->depth--;
+    s->hand_key += kind_key(moves[i].kind);
+    unmake_move(s->field, s->hand, &u);
+    STAT(s->stats.root_us[i] += monotonic_us());
+
+    if(s->budget != NULL && atomic_load(&s->budget->stop))
+      return;
+  }
+}
+
+static bool anytime_search(Search* s, int threads) {
+  for(int limit = 1; ; limit *= 2) {
+    s->limit = (limit >= s->hand->size) ? INT_MAX : limit;
+    s->horizons = 0;
+
+    search_root(s, threads);
+
+    if(atomic_load(&s->budget->stop))
+      return false;
+    //un'iterazione che non ha mai raggiunto il limite è già una ricerca esatta
+    if(s->limit == INT_MAX || s->horizons == 0)
+      return true;
+  }
+}
+
+static Tile move_oriented(Move const* m) {
+  Tile el = kind_tile(m->kind);
+
+  if(m->flip) {
+    int left = el.left;
+    el.left = el.right;
+    el.right = left;
+  }
+
+  return el;
+}
+
+static bool search_init(Search* s, Field* field, Hand* hand, Options const* opt, TTable* tt, atomic_int* best, long stats_interval) {
+  s->field = field;
+  s->hand = hand;
+  s->hand_key = hand_key(hand);
+  s->tt = tt;
+  s->best = best;
+  s->use_best = true;
+  s->graph = opt->engine == ENGINE_GRAPH;
+  s->tb = opt->tb;
+  s->budget = NULL;
+  s->line = NULL;
+  s->depth = 0;
+  s->limit = INT_MAX;
+  s->nodes = 0;
+  s->cutoffs = 0;
+  s->horizons = 0;
+  s->progress = NULL;
+  STAT(stats_init(&s->stats, stats_interval, opt->stats));
+  s->path = (Move*)arena_alloc(field->tiles->arena, sizeof(Move) * (hand->size+1));
+  s->trail = (uint8_t*)arena_alloc(field->tiles->arena, 2 * (hand->size+3));
+  return s->path != NULL && s->trail != NULL;
+}
+
+static void search_free(Search* s) {
+  arena_release(s->field->tiles->arena, s->path);
+  arena_release(s->field->tiles->arena, s->trail);
+}
+
+static int extract_pv(Search* s, int best, Move* pv, Undo* played) {
+  Field* field = s->field;
+
+  //i rami vanno valutati rispetto al target, non al miglior punteggio già trovato
+  int target = best - field->total;
+  int n = 0;
+
+  s->use_best = false;
+  s->budget = NULL;
+  s->line = NULL;
+  s->limit = INT_MAX;
+  while(best_move(s, &target, &pv[n], &played[n]))
+    n++;
+  for(int i=n-1; i>=0; i--)
+    unmake_move(field, s->hand, &played[i]);
+
+  return n;
+}
+
+static bool solve(Field* field, Hand* hand, Options const* opt, TTable* tt, Result* result) {
+  if(opt->engine == ENGINE_BEAM)
+    return beam_search(field, hand, opt->beam_width, result);
+
+  atomic_int best;
+  atomic_init(&best, field->total);
+
+  //il campo non viene mai ridimensionato durante la ricerca, e la memoria temporanea viene rilasciata tutta alla fine
+  Arena* arena = field->tiles->arena;
+  if(!reserve_deque(field->tiles, field->tiles->size + hand->size + 1))
+    return false;
+  ArenaMark mark = arena_mark(arena);
+
+  Budget budget;
+  Line line;
+  bool anytime = opt->time_ms > 0 || opt->max_nodes > 0;
+  int threads = opt->threads;
+
+  //tutta la memoria viene presa prima della ricerca, che poi non può più fallire
+  Search s;
+  bool ok = search_init(&s, field, hand, opt, tt, &best, opt->stats ? opt->stats_interval : 0);
+  Move* pv = (Move*)arena_alloc(arena, sizeof(Move) * (hand->size+1));
+  Undo* played = (Undo*)arena_alloc(arena, sizeof(Undo) * (hand->size+1));
+  line.moves = anytime ? (Move*)arena_alloc(arena, sizeof(Move) * (hand->size+1)) : NULL;
+  ok = ok && pv != NULL && played != NULL && (!anytime || line.moves != NULL) &&
+       move_stack_init(&result->line, hand->size);
+  if(!ok) {
+    arena_release(arena, line.moves);
+    arena_release(arena, played);
+    arena_release(arena, pv);
+    search_free(&s);
+    arena_rewind(arena, mark);
+    return false;
+  }
+
+  result->proven = true;
+  result->optimum = -1;
+  if(anytime) {
+    budget.deadline = (opt->time_ms > 0) ? monotonic_ms() + opt->time_ms : 0;
+    budget.max_nodes = opt->max_nodes;
+    atomic_init(&budget.nodes, 0);
+    atomic_init(&budget.stop, false);
+
+    pthread_mutex_init(&line.lock, NULL);
+    line.length = 0;
+    atomic_init(&line.total, field->total);
+
+    s.budget = &budget;
+    s.line = &line;
+  }
+
+  Progress reporter;
+  if(opt->progress != NULL) {
+    progress_start(&reporter, &best, s.budget, opt->progress);
+    s.progress = &reporter;
+  }
+
+  if(anytime)
+    result->proven = anytime_search(&s, threads);
+  else
+    search_root(&s, threads);
+
+  //la partita ottima viene ricostruita; se il budget è esaurito si gioca la miglior partita completa registrata
+  Move const* moves = pv;
+  int n_moves;
+  if(result->proven) {
+    n_moves = extract_pv(&s, atomic_load(&best), pv, played);
+  } else {
+    moves = line.moves;
+    n_moves = line.length;
+  }
+
+  int n_played;
+  for(n_played=0; n_played<n_moves; n_played++) {
+    Move const* m = &moves[n_played];
+    make_move(field, hand, m->kind, m->pos, m->flip, &played[n_played]);
+    move_stack_push(&result->line, field, m);
+  }
+
+  if(opt->progress != NULL)
+    progress_stop(&reporter);
+
+  result->total = points(field);
+  result->nodes = s.nodes;
+  result->cutoffs = s.cutoffs;
+  STAT(result->stats = s.stats);
+
+  while(n_played > 0) {
+    n_played--;
+    unmake_move(field, hand, &played[n_played]);
+  }
+
+  if(anytime) {
+    pthread_mutex_destroy(&line.lock);
+    arena_release(arena, line.moves);
+  }
+  search_free(&s);
+  arena_release(arena, pv);
+  arena_release(arena, played);
+  arena_rewind(arena, mark);
+  return true;
+}
+
+/*
+Funzioni per la cache persistente dei risultati
+*/
+
+static uint64_t hand_fingerprint(Hand const* hand, uint16_t count[TILE_KINDS]) {
+  memset(count, 0, sizeof(uint16_t) * TILE_KINDS);
+  for(int k=0; k<TILE_KINDS; k++)
+    count[canonical_kind(k)] += hand->count[k];
+
+  //hand_key conta già insieme [a|b] e [b|a]
+  return hand_key(hand);
+}
+
+/**
+ * @brief Funzione ausiliaria che calcola il checksum di un record: FNV-1a sui byte che seguono il campo checksum
+ * @param r record
+ * @return Il checksum
+*/
+static uint32_t cache_checksum(CacheRecord const* r) {
+  uint8_t const* p = (uint8_t const*)r + offsetof(CacheRecord, key);
+  size_t n = r->length - offsetof(CacheRecord, key);
+  uint32_t h = 2166136261u;
+
+  for(size_t i=0; i<n; i++) {
+    h ^= p[i];
+    h *= 16777619u;
+  }
+
+  return h;
+}
+
+/**
+ * @brief Funzione ausiliaria che inizializza un indice vuoto
+ * @param index CacheIndex da inizializzare
+ * @param capacity numero di elementi, potenza di 2
+ * @return true se l'indice è stato allocato, false se la memoria non basta
+*/
+static bool cache_index_init(CacheIndex* index, size_t capacity) {
+  index->slots = (CacheSlot*)calloc(capacity, sizeof(CacheSlot));
+  index->mask = capacity - 1;
+  index->used = 0;
+  return index->slots != NULL;
+}
+
+/**
+ * @brief Funzione ausiliaria che cerca una mano nell'indice
+ * @param index indice
+ * @param key chiave hash dell'impronta
+ * @param count impronta della mano
+ * @return L'elemento della mano, oppure l'elemento vuoto in cui inserirla
+*/
+static CacheSlot* cache_index_find(CacheIndex const* index, uint64_t key, uint16_t const count[TILE_KINDS]) {
+  for(size_t i = mix64(key) & index->mask; ; i = (i+1) & index->mask) {
+    CacheSlot* slot = &index->slots[i];
+    CacheRecord const* r = slot->record;
+    if(r == NULL || (r->key == key && memcmp(r->count, count, sizeof(r->count)) == 0))
+      return slot;
+  }
+}
+
+/**
+ * @brief Funzione ausiliaria che inserisce un record nell'indice raddoppiandolo se è pieno a metà.
+ * Un record della stessa mano già presente viene sostituito, tenendo l'uso più recente dei due
+ * @param index indice
+ * @param r record
+ * @param stamp istante dell'ultimo uso del record
+ * @return true se il record è stato inserito, false se l'indice va raddoppiato e la memoria non basta
+*/
+static bool cache_index_put(CacheIndex* index, CacheRecord const* r, uint64_t stamp) {
+  if(2*(index->used+1) > index->mask+1) {
+    CacheIndex grown;
+    if(!cache_index_init(&grown, 2*(index->mask+1)))
+      return false;
+    for(size_t i=0; i<=index->mask; i++)
+      if(index->slots[i].record != NULL)
+        *cache_index_find(&grown, index->slots[i].record->key, index->slots[i].record->count) = index->slots[i];
+    grown.used = index->used;
+    free(index->slots);
+    *index = grown;
+  }
+
+  CacheSlot* slot = cache_index_find(index, r->key, r->count);
+  if(slot->record == NULL) {
+    index->used++;
+    slot->stamp = stamp;
+  } else if(stamp > slot->stamp) {
+    slot->stamp = stamp;
+  }
+  slot->record = r;
+  return true;
+}
+
+/**
+ * @brief Funzione ausiliaria che indicizza i record validi di un file mappato, fermandosi al primo record
+ * incompleto o corrotto
+ * @param index indice in cui inserire i record
+ * @param map file mappato, intestazione compresa
+ * @param size dimensione del file
+ * @return La fine dell'ultimo record valido
+*/
+static size_t cache_scan(CacheIndex* index, uint8_t const* map, size_t size) {
+  size_t offset = CACHE_HEADER_SIZE;
+
+  while(size - offset >= sizeof(CacheRecord)) {
+    CacheRecord const* r = (CacheRecord const*)(map + offset);
+    if(r->length < sizeof(CacheRecord) || r->length % 8 != 0 || r->length > size - offset ||
+       sizeof(CacheRecord) + 2*(size_t)r->n_moves > r->length || cache_checksum(r) != r->checksum)
+      break;
+
+    //un record che non entra nell'indice resta nel file: non viene trovato, ma la fine dei record validi non cambia
+    cache_index_put(index, r, r->stamp);
+    offset += r->length;
+  }
+
+  return offset;
+}
+
+/**
+ * @brief Funzione ausiliaria che prende o rilascia il lock sul file della cache, condiviso tra i processi
+ * @param cache Cache
+ * @param type F_RDLCK, F_WRLCK o F_UNLCK
+*/
+static void cache_lock(Cache const* cache, short type) {
+  struct flock fl;
+  memset(&fl, 0, sizeof(fl));
+  fl.l_type = type;
+  fl.l_whence = SEEK_SET;
+
+  while(fcntl(cache->lock_fd, F_SETLKW, &fl) < 0 && errno == EINTR);
+}
+
+/**
+ * @brief Funzione ausiliaria che scrive tutto il buffer su un file
+ * @param fd descrittore del file
+ * @param data buffer
+ * @param n numero di byte
+ * @return true se la scrittura è riuscita
+*/
+static bool write_all(int fd, void const* data, size_t n) {
+  uint8_t const* p = (uint8_t const*)data;
+
+  while(n > 0) {
+    ssize_t w = write(fd, p, n);
+    if(w < 0 && errno == EINTR) continue;
+    if(w <= 0) return false;
+    p += w;
+    n -= (size_t)w;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Funzione ausiliaria che confronta due elementi dell'indice per uso più recente, per qsort
+ * @param a primo CacheSlot
+ * @param b secondo CacheSlot
+ * @return Un valore negativo se a è stato usato più di recente di b
+*/
+static int cmp_slot_stamp(void const* a, void const* b) {
+  uint64_t sa = ((CacheSlot const*)a)->stamp;
+  uint64_t sb = ((CacheSlot const*)b)->stamp;
+  return (sa < sb) - (sa > sb);
+}
+
+/**
+ * @brief Funzione ausiliaria che riscrive il file della cache con i record usati più di recente, fino a metà della
+ * dimensione massima, più il nuovo record. Il nuovo file sostituisce il vecchio con rename, quindi chi lo ha mappato
+ * continua a leggere il vecchio. Va chiamata con il lock in scrittura
+ * @param cache Cache
+ * @param fd descrittore del file attuale
+ * @param size dimensione del file attuale
+ * @param extra nuovo record
+*/
+static void cache_compact(Cache* cache, int fd, size_t size, CacheRecord const* extra) {
+  //il file attuale può contenere record aggiunti da altri processi dopo l'apertura della cache, quindi viene riletto
+  uint8_t const* map = NULL;
+  if(size >= CACHE_HEADER_SIZE) {
+    void* p = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if(p != MAP_FAILED)
+      map = (uint8_t const*)p;
+  }
+
+  //se la memoria non basta il file resta com'è e il nuovo record non viene salvato
+  CacheIndex live;
+  CacheSlot* kept = NULL;
+  char* tmp = (char*)malloc(strlen(cache->path) + 32);
+  bool ok = tmp != NULL && cache_index_init(&live, 64);
+  if(ok && map != NULL && memcmp(map, CACHE_MAGIC, 8) == 0)
+    cache_scan(&live, map, size);
+  ok = ok && cache_index_put(&live, extra, extra->stamp);
+  if(ok) {
+    kept = (CacheSlot*)malloc(sizeof(CacheSlot) * live.used);
+    ok = kept != NULL;
+  }
+  if(!ok) {
+    if(tmp != NULL)
+      free(live.slots);
+    free(tmp);
+    if(map != NULL)
+      munmap((void*)map, size);
+    return;
+  }
+
+  //l'ultimo uso noto a questo processo conta quanto quello salvato nel file
+  size_t n = 0;
+  for(size_t i=0; i<=live.mask; i++) {
+    CacheSlot s = live.slots[i];
+    if(s.record == NULL) continue;
+    CacheSlot const* own = cache_index_find(&cache->index, s.record->key, s.record->count);
+    if(own->record != NULL && own->stamp > s.stamp)
+      s.stamp = own->stamp;
+    kept[n++] = s;
+  }
+  qsort(kept, n, sizeof(CacheSlot), cmp_slot_stamp);
+
+  sprintf(tmp, "%s.tmp.%ld", cache->path, (long)getpid());
+
+  int out = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  uint8_t header[CACHE_HEADER_SIZE] = {0};
+  memcpy(header, CACHE_MAGIC, 8);
+  ok = out >= 0 && write_all(out, header, CACHE_HEADER_SIZE);
+  size_t bytes = CACHE_HEADER_SIZE;
+
+  for(size_t i=0; ok && i<n; i++) {
+    CacheRecord const* r = kept[i].record;
+    if(bytes + r->length > cache->max_bytes / 2)
+      continue;
+
+    //lo stamp fa parte del checksum, quindi il record viene copiato e richiuso; senza memoria il file non viene sostituito
+    CacheRecord* copy = (CacheRecord*)malloc(r->length);
+    ok = copy != NULL;
+    if(!ok) break;
+    memcpy(copy, r, r->length);
+    copy->stamp = kept[i].stamp;
+    copy->checksum = cache_checksum(copy);
+    ok = write_all(out, copy, copy->length);
+    bytes += copy->length;
+    free(copy);
+  }
+
+  if(out >= 0)
+    close(out);
+  if(!ok || rename(tmp, cache->path) != 0)
+    unlink(tmp);
+
+  free(tmp);
+  free(kept);
+  free(live.slots);
+  if(map != NULL)
+    munmap((void*)map, size);
+}
+
+/**
+ * @brief Funzione ausiliaria che aggiunge un record in coda al file della cache, riscrivendolo se è pieno o se
+ * termina con un record scritto a metà. Va chiamata con il lock in scrittura
+ * @param cache Cache
+ * @param r record
+*/
+static void cache_append(Cache* cache, CacheRecord const* r) {
+  int fd = open(cache->path, O_RDWR | O_CREAT | O_APPEND, 0644);
+  if(fd < 0) return;
+
+  struct stat st;
+  if(fstat(fd, &st) == 0) {
+    size_t size = (size_t)st.st_size;
+    //un record incompleto in coda nasconderebbe tutti quelli scritti dopo
+    bool torn = size == cache->map_size && cache->valid_end < cache->map_size;
+
+    if(size == 0) {
+      uint8_t header[CACHE_HEADER_SIZE] = {0};
+      memcpy(header, CACHE_MAGIC, 8);
+      if(write_all(fd, header, CACHE_HEADER_SIZE))
+        write_all(fd, r, r->length);
+    } else if(torn || size + r->length > cache->max_bytes) {
+      cache_compact(cache, fd, size, r);
+    } else {
+      write_all(fd, r, r->length);
+    }
+  }
+
+  close(fd);
+}
+
+static int cache_open(Cache* cache, char const* path, size_t max_mb) {
+  cache->path = (char*)malloc(strlen(path) + 1);
+  cache->max_bytes = max_mb * 1024 * 1024;
+  cache->map = NULL;
+  cache->map_size = 0;
+  cache->valid_end = 0;
+  cache->added = NULL;
+  cache->n_added = 0;
+  cache->added_capacity = 0;
+  cache->lock_fd = -1;
+  pthread_mutex_init(&cache->lock, NULL);
+
+  //il lock è su un file a parte perché il file della cache viene sostituito quando è pieno
+  char* lock_path = (char*)malloc(strlen(path) + 6);
+  bool ok = cache_index_init(&cache->index, 64) && cache->path != NULL && lock_path != NULL;
+  if(!ok) {
+    free(lock_path);
+    return DOMINO_ERR_NO_MEMORY;
+  }
+  strcpy(cache->path, path);
+  sprintf(lock_path, "%s.lock", path);
+  cache->lock_fd = open(lock_path, O_RDWR | O_CREAT, 0644);
+  free(lock_path);
+  if(cache->lock_fd < 0)
+    return DOMINO_ERR_IO;
+
+  cache_lock(cache, F_RDLCK);
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if(fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+    void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if(p != MAP_FAILED) {
+      cache->map = (uint8_t const*)p;
+      cache->map_size = (size_t)st.st_size;
+    }
+  }
+  if(fd >= 0)
+    close(fd);
+  cache_lock(cache, F_UNLCK);
+
+  if(cache->map == NULL) return DOMINO_OK;
+
+  //un file che non è una cache non viene mai sovrascritto
+  if(cache->map_size < CACHE_HEADER_SIZE || memcmp(cache->map, CACHE_MAGIC, 8) != 0) {
+    munmap((void*)cache->map, cache->map_size);
+    cache->map = NULL;
+    cache->map_size = 0;
+    close(cache->lock_fd);
+    cache->lock_fd = -1;
+    return DOMINO_ERR_BAD_FILE;
+  }
+
+  cache->valid_end = cache_scan(&cache->index, cache->map, cache->map_size);
+  return DOMINO_OK;
+}
+
+static void cache_close(Cache* cache) {
+  if(cache->map != NULL)
+    munmap((void*)cache->map, cache->map_size);
+  for(size_t i=0; i<cache->n_added; i++)
+    free(cache->added[i]);
+  free(cache->added);
+  free(cache->index.slots);
+  if(cache->lock_fd >= 0)
+    close(cache->lock_fd);
+  pthread_mutex_destroy(&cache->lock);
+  free(cache->path);
+}
+
+/**
+ * @brief Funzione ausiliaria che decodifica una mossa salvata e controlla che sia giocabile.
+ * La mano può contenere [b|a] al posto della [a|b] salvata: è la stessa tessera girata
+ * @param code mossa codificata
+ * @param field campo di gioco
+ * @param hand mano del giocatore
+ * @param m Move in cui viene scritta la mossa
+ * @return true se la mossa è giocabile
+*/
+static bool cache_move(uint8_t const* code, Field const* field, Hand const* hand, Move* m) {
+  int kind = code[0];
+  int side = code[1] & 3;
+  bool flip = (code[1] & 4) != 0;
+  if(kind >= TILE_KINDS || side > 2) return false;
+
+  if(hand->count[kind] == 0 && kind < SUM_KIND) {
+    kind = (kind%6)*6 + kind/6;
+    flip = !flip;
+  }
+  if(hand->count[kind] == 0) return false;
+
+  m->kind = kind;
+  m->pos = "SLR"[side];
+  m->flip = flip;
+  return valid_move(field, m->pos, move_oriented(m));
+}
+
+static bool cache_lookup(Cache* cache, Field* field, Hand* hand, Result* result) {
+  if(field->tiles->size > 0) return false;
+
+  uint16_t count[TILE_KINDS];
+  uint64_t key = hand_fingerprint(hand, count);
+
+  //i record restano in memoria fino alla chiusura della cache, quindi possono essere letti senza lock
+  pthread_mutex_lock(&cache->lock);
+  CacheSlot* slot = cache_index_find(&cache->index, key, count);
+  CacheRecord const* r = slot->record;
+  if(r != NULL)
+    slot->stamp = (uint64_t)time(NULL);
+  pthread_mutex_unlock(&cache->lock);
+
+  if(r == NULL || r->n_moves > hand->size) return false;
+
+  //le mosse vengono rigiocate: un record che non porta al punteggio salvato viene ignorato, come uno che non si
+  //può rigiocare per mancanza di memoria
+  Undo* played = (Undo*)malloc(sizeof(Undo) * (r->n_moves+1));
+  if(played == NULL || !move_stack_init(&result->line, hand->size)) {
+    free(played);
+    return false;
+  }
+
+  uint8_t const* code = (uint8_t const*)(r+1);
+  int n_played = 0;
+  Move m;
+  while(n_played < r->n_moves && cache_move(code + 2*n_played, field, hand, &m)) {
+    make_move(field, hand, m.kind, m.pos, m.flip, &played[n_played]);
+    move_stack_push(&result->line, field, &m);
+    n_played++;
+  }
+  bool valid = n_played == r->n_moves && points(field) == r->total;
+
+  while(n_played > 0) {
+    n_played--;
+    unmake_move(field, hand, &played[n_played]);
+  }
+  free(played);
+
+  if(!valid) {
+    move_stack_free(&result->line);
+    return false;
+  }
+
+  result->total = r->total;
+  result->proven = true;
+  result->optimum = -1;
+  result->nodes = 0;
+  result->cutoffs = 0;
+  STAT(stats_init(&result->stats, 0, NULL));
+  return true;
+}
+
+static void cache_store(Cache* cache, Hand const* hand, Result const* result) {
+  if(cache->lock_fd < 0) return;
+
+  size_t length = (sizeof(CacheRecord) + 2*(size_t)result->line.size + 7) & ~(size_t)7;
+  //senza memoria il risultato non viene salvato
+  CacheRecord* r = (CacheRecord*)calloc(1, length);
+  if(r == NULL) return;
+  r->length = (uint32_t)length;
+  r->key = hand_fingerprint(hand, r->count);
+  r->stamp = (uint64_t)time(NULL);
+  r->total = result->total;
+  r->n_moves = (uint16_t)result->line.size;
+
+  uint8_t* code = (uint8_t*)(r+1);
+  for(int i=0; i<result->line.size; i++) {
+    Move const* m = &result->line.data[i].move;
+    code[2*i] = m->kind;
+    code[2*i+1] = (m->pos == 'L' ? 1 : m->pos == 'R' ? 2 : 0) | (m->flip ? 4 : 0);
+  }
+  r->checksum = cache_checksum(r);
+
+  pthread_mutex_lock(&cache->lock);
+  //un altro thread può aver già risolto la stessa mano
+  if(cache_index_find(&cache->index, r->key, r->count)->record != NULL) {
+    pthread_mutex_unlock(&cache->lock);
+    free(r);
+    return;
+  }
+
+  if(cache->n_added == cache->added_capacity) {
+    size_t capacity = cache->added_capacity ? 2*cache->added_capacity : 16;
+    CacheRecord** added = (CacheRecord**)realloc(cache->added, sizeof(CacheRecord*) * capacity);
+    if(added == NULL) {
+      pthread_mutex_unlock(&cache->lock);
+      free(r);
+      return;
+    }
+    cache->added = added;
+    cache->added_capacity = capacity;
+  }
+
+  cache_lock(cache, F_WRLCK);
+  cache_append(cache, r);
+  cache_lock(cache, F_UNLCK);
+
+  cache->added[cache->n_added++] = r;
+  cache_index_put(&cache->index, r, r->stamp);
+  pthread_mutex_unlock(&cache->lock);
+}
+
+static bool cached_solve(Field* field, Hand* hand, Options const* opt, TTable* tt, Result* result, bool* hit) {
+  Cache* cache = opt->cache;
+  *hit = false;
+  if(opt->engine == ENGINE_BEAM) {
+    if(!solve(field, hand, opt, tt, result))
+      return false;
+
+    //l'ottimo con cui confrontare la partita trovata viene dalla cache o, con --beam-exact, dalla ricerca esatta
+    Result exact;
+    bool known = false;
+    if(opt->beam_exact) {
+      Options exact_opt = *opt;
+      exact_opt.engine = ENGINE_SEARCH;
+      bool exact_hit;
+      if(!cached_solve(field, hand, &exact_opt, tt, &exact, &exact_hit)) {
+        move_stack_free(&result->line);
+        return false;
+      }
+      known = true;
+    } else if(cache != NULL) {
+      known = cache_lookup(cache, field, hand, &exact);
+    }
+
+    if(known) {
+      if(exact.proven)
+        result->optimum = exact.total;
+      move_stack_free(&exact.line);
+    }
+    return true;
+  }
+
+  if(cache != NULL && cache_lookup(cache, field, hand, result)) {
+    *hit = true;
+    return true;
+  }
+
+  if(!solve(field, hand, opt, tt, result))
+    return false;
+
+  if(cache != NULL && result->proven && field->tiles->size == 0)
+    cache_store(cache, hand, result);
+
+  return true;
+}
+
+/*
+Funzioni per i suggerimenti della modalità interattiva
+*/
+
+static bool hint_start(HintEngine* e, Field const* field, Hand const* hand, Options const* opt) {
+  //la copia del campo eredita la capacità riservata per tutta la partita, quindi la ricerca non la ingrandisce
+  e->field = clone_field(field);
+  e->line.moves = (Move*)malloc(sizeof(Move) * (hand->size+1));
+  if(e->field == NULL || e->line.moves == NULL || !tt_create(&e->tt, opt->tt_mb)) {
+    free_field(e->field);
+    free(e->line.moves);
+    return false;
+  }
+
+  pthread_mutex_init(&e->lock, NULL);
+  pthread_cond_init(&e->wake, NULL);
+  e->pending = true;
+  e->busy = true;
+  e->quit = false;
+  e->proven = false;
+  e->hand = *hand;
+  //la ricerca dei suggerimenti non usa la cache e non mostra né avanzamento né statistiche
+  e->opt = *opt;
+  e->opt.cache = NULL;
+  e->opt.progress = NULL;
+  e->opt.stats = NULL;
+
+  e->budget.deadline = 0;
+  e->budget.max_nodes = 0;
+  atomic_init(&e->budget.nodes, 0);
+  atomic_init(&e->budget.stop, false);
+
+  pthread_mutex_init(&e->line.lock, NULL);
+  e->line.length = 0;
+  atomic_init(&e->line.total, field->total);
+  atomic_init(&e->best, field->total);
+
+  pthread_create(&e->thread, NULL, hint_worker, e);
+  return true;
+}
+
+/**
+ * @brief Funzione ausiliaria che controlla se due posizioni hanno lo stesso campo e la stessa mano
+ * @param a primo campo
+ * @param ha prima mano
+ * @param b secondo campo
+ * @param hb seconda mano
+ * @return true se le posizioni coincidono
+*/
+static bool same_position(Field const* a, Hand const* ha, Field const* b, Hand const* hb) {
+  if(ha->size != hb->size || memcmp(ha->count, hb->count, sizeof(ha->count)) != 0) return false;
+  if(a->tiles->size != b->tiles->size || a->total != b->total) return false;
+
+  for(size_t i=0; i<a->tiles->size; i++) {
+    Tile x = field_at(a, i);
+    Tile y = field_at(b, i);
+    if(x.left != y.left || x.right != y.right) return false;
+  }
+
+  return true;
+}
+
+static void hint_update(HintEngine* e, Field const* field, Hand const* hand) {
+  //l'analisi in corso viene interrotta: campo, mano e partita del motore si possono toccare solo a thread fermo
+  atomic_store(&e->budget.stop, true);
+  pthread_mutex_lock(&e->lock);
+  while(e->busy)
+    pthread_cond_wait(&e->wake, &e->lock);
+
+  bool follows = false;
+  if(e->line.length > 0) {
+    Move const* m = &e->line.moves[0];
+    Undo u;
+    make_move(e->field, &e->hand, m->kind, m->pos, m->flip, &u);
+    follows = same_position(e->field, &e->hand, field, hand);
+  }
+
+  //se il giocatore ha seguito il suggerimento il resto della partita vale ancora, e resta ottimo se lo era
+  if(follows) {
+    memmove(e->line.moves, e->line.moves + 1, sizeof(Move) * (e->line.length - 1));
+    e->line.length -= 1;
+  } else {
+    e->line.length = 0;
+    atomic_store(&e->line.total, field->total);
+    e->proven = false;
+  }
+
+  //e->field ha già la capacità del campo della partita, quindi la copia non alloca
+  copy_field(field, e->field);
+  e->hand = *hand;
+  atomic_store(&e->budget.stop, false);
+  e->pending = !e->proven;
+  e->busy = e->pending;
+  pthread_cond_broadcast(&e->wake);
+  pthread_mutex_unlock(&e->lock);
+}
+
+static void hint_stop(HintEngine* e) {
+  atomic_store(&e->budget.stop, true);
+  pthread_mutex_lock(&e->lock);
+  e->quit = true;
+  pthread_cond_broadcast(&e->wake);
+  pthread_mutex_unlock(&e->lock);
+  pthread_join(e->thread, NULL);
+
+  free_field(e->field);
+  tt_free(&e->tt);
+  free(e->line.moves);
+  pthread_mutex_destroy(&e->line.lock);
+  pthread_cond_destroy(&e->wake);
+  pthread_mutex_destroy(&e->lock);
+}
+
+static bool hint_get(HintEngine* e, Move* move, int* total, bool* proven) {
+  pthread_mutex_lock(&e->lock);
+  *proven = e->proven;
+  pthread_mutex_unlock(&e->lock);
+
+  pthread_mutex_lock(&e->line.lock);
+  bool found = e->line.length > 0;
+  if(found) {
+    *move = e->line.moves[0];
+    *total = atomic_load(&e->line.total);
+  }
+  pthread_mutex_unlock(&e->line.lock);
+
+  return found;
+}
+
+static void hint_analyse(HintEngine* e) {
+  Field* field = e->field;
+  Hand* hand = &e->hand;
+  if(!possible_moves(field, hand)) return;
+
+  //la partita conservata dal turno precedente è già un punteggio da superare
+  atomic_store(&e->best, atomic_load(&e->line.total));
+
+  //senza memoria il turno resta senza analisi: il suggerimento è quello del turno precedente, se lo segue
+  Search s;
+  bool ok = search_init(&s, field, hand, &e->opt, &e->tt, &e->best, 0);
+  Move* pv = (Move*)malloc(sizeof(Move) * (hand->size+1));
+  Undo* played = (Undo*)malloc(sizeof(Undo) * (hand->size+1));
+  s.budget = &e->budget;
+  s.line = &e->line;
+
+  if(ok && pv != NULL && played != NULL && anytime_search(&s, 1)) {
+    //la partita ottima sostituisce quella trovata dalla ricerca
+    int best = atomic_load(&e->best);
+    int n = extract_pv(&s, best, pv, played);
+
+    pthread_mutex_lock(&e->line.lock);
+    memcpy(e->line.moves, pv, sizeof(Move) * n);
+    e->line.length = n;
+    atomic_store(&e->line.total, best);
+    pthread_mutex_unlock(&e->line.lock);
+
+    pthread_mutex_lock(&e->lock);
+    e->proven = true;
+    pthread_mutex_unlock(&e->lock);
+  }
+
+  search_free(&s);
+  free(pv);
+  free(played);
+}
+
+static void* hint_worker(void* arg) {
+  HintEngine* e = (HintEngine*)arg;
+
+  pthread_mutex_lock(&e->lock);
+  while(true) {
+    while(!e->pending && !e->quit)
+      pthread_cond_wait(&e->wake, &e->lock);
+    if(e->quit) break;
+
+    e->pending = false;
+    pthread_mutex_unlock(&e->lock);
+    hint_analyse(e);
+    pthread_mutex_lock(&e->lock);
+
+    e->busy = false;
+    pthread_cond_broadcast(&e->wake);
+  }
+  pthread_mutex_unlock(&e->lock);
+
+  return NULL;
+}
+
+/*
+Funzioni per l'avanzamento della ricerca
+*/
+
+static void progress_start(Progress* p, atomic_int* best, Budget const* budget, FILE* out) {
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->wake, NULL);
+  p->stop = false;
+  atomic_init(&p->nodes, 0);
+  atomic_init(&p->done, 0);
+  atomic_init(&p->total, 0);
+  p->best = best;
+  p->budget = budget;
+  p->start_ms = monotonic_ms();
+  p->tty = isatty(fileno(out));
+  p->out = out;
+
+  pthread_create(&p->thread, NULL, progress_worker, p);
+}
+
+static void progress_stop(Progress* p) {
+  pthread_mutex_lock(&p->lock);
+  p->stop = true;
+  pthread_cond_signal(&p->wake);
+  pthread_mutex_unlock(&p->lock);
+  pthread_join(p->thread, NULL);
+
+  if(p->tty) {
+    fprintf(p->out, "\r\033[K");
+    fflush(p->out);
+  }
+  pthread_cond_destroy(&p->wake);
+  pthread_mutex_destroy(&p->lock);
+}
+
+static void progress_report(Progress* p) {
+  long long elapsed = monotonic_ms() - p->start_ms;
+  unsigned long long nodes = atomic_load_explicit(&p->nodes, memory_order_relaxed);
+  long done = atomic_load_explicit(&p->done, memory_order_relaxed);
+  long total = atomic_load_explicit(&p->total, memory_order_relaxed);
+  double rate = elapsed > 0 ? nodes * 1000.0 / elapsed : 0;
+
+  //la stima usa la frazione più avanzata tra sotto-alberi della radice, tempo e posizioni del budget
+  double fraction = total > 0 ? (double)done / total : 0;
+  if(p->budget != NULL && p->budget->deadline > 0) {
+    double f = (double)elapsed / (p->budget->deadline - p->start_ms);
+    if(f > fraction) fraction = f;
+  }
+  if(p->budget != NULL && p->budget->max_nodes > 0) {
+    double f = (double)nodes / p->budget->max_nodes;
+    if(f > fraction) fraction = f;
+  }
+  if(fraction > 1) fraction = 1;
+
+  fprintf(p->out, "%sProgress: %3.0f%% | nodes %llu | %.0f nodes/s | best %d | elapsed %.1fs",
+          p->tty ? "\r\033[K" : "", fraction*100, nodes, rate, atomic_load(p->best), elapsed / 1000.0);
+  if(fraction > 0)
+    fprintf(p->out, " | eta %.1fs", elapsed * (1-fraction) / fraction / 1000.0);
+  if(!p->tty)
+    fprintf(p->out, "\n");
+  fflush(p->out);
+}
+
+static void* progress_worker(void* arg) {
+  Progress* p = (Progress*)arg;
+  long interval = p->tty ? PROGRESS_TTY_MS : PROGRESS_LOG_MS;
+
+  pthread_mutex_lock(&p->lock);
+  while(!p->stop) {
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += interval / 1000;
+    until.tv_nsec += (interval % 1000) * 1000000;
+    if(until.tv_nsec >= 1000000000) {
+      until.tv_sec += 1;
+      until.tv_nsec -= 1000000000;
+    }
+
+    //il thread si sveglia allo scadere dell'intervallo o quando la ricerca termina
+    if(pthread_cond_timedwait(&p->wake, &p->lock, &until) != 0 && !p->stop)
+      progress_report(p);
+  }
+  pthread_mutex_unlock(&p->lock);
+
+  return NULL;
+}
+
+
+/*
+Funzioni per il contesto del risolutore
+*/
+
+static void options_init(Options* opt) {
+  opt->tt_mb = TT_DEFAULT_MB;
+  opt->threads = 1;
+  opt->time_ms = 0;
+  opt->max_nodes = 0;
+  opt->stats = NULL;
+  opt->stats_interval = STATS_DEFAULT_INTERVAL;
+  opt->progress = NULL;
+  opt->engine = ENGINE_SEARCH;
+  opt->beam_width = BEAM_DEFAULT_WIDTH;
+  opt->beam_exact = false;
+  opt->cache = NULL;
+  opt->tb = NULL;
+}
+
+static bool read_hand(Hand* hand, DominoTile const* tiles, int n) {
+  hand_init(hand);
+
+  for(int i=0; i<n; i++) {
+    Tile el;
+    el.left = tiles[i].left;
+    el.right = tiles[i].right;
+
+    int kind = tile_kind(el);
+    if(kind < 0 || hand->count[kind] == HAND_KIND_MAX) return false;
+    hand_add(hand, kind);
+  }
+
+  return hand->count[SUM_KIND] <= HAND_SUM_MAX;
+}
+
+char const* domino_strerror(int status) {
+  switch(status) {
+    case DOMINO_OK: return "Success";
+    case DOMINO_ERR_INVALID_HAND: return "Invalid tile in input";
+    case DOMINO_ERR_INVALID_ARGUMENT: return "Invalid argument";
+    case DOMINO_ERR_NO_MEMORY: return "Memory allocation failed";
+    case DOMINO_ERR_IO: return "Input/output error";
+    case DOMINO_ERR_BAD_FILE: return "Invalid or truncated file";
+    case DOMINO_ERR_ILLEGAL_MOVE: return "Illegal move";
+    default: return "Unknown error";
+  }
+}
+
+uint64_t domino_seed_mix(uint64_t x) {
+  return mix64(x);
+}
+
+void domino_options_default(DominoOptions* options) {
+  Options opt;
+  options_init(&opt);
+
+  options->engine = opt.engine;
+  options->threads = opt.threads;
+  options->tt_mb = opt.tt_mb;
+  options->time_ms = opt.time_ms;
+  options->max_nodes = opt.max_nodes;
+  options->beam_width = opt.beam_width;
+  options->beam_exact = opt.beam_exact;
+  options->cache = NULL;
+  options->tablebase = NULL;
+  options->progress = NULL;
+  options->stats = NULL;
+  options->stats_interval = opt.stats_interval;
+}
+
+int domino_solver_create(DominoOptions const* options, uint64_t seed, uint64_t stream, DominoSolver** solver) {
+  DominoOptions defaults;
+  if(options == NULL) {
+    domino_options_default(&defaults);
+    options = &defaults;
+  }
+
+  bool valid_engine = options->engine == DOMINO_ENGINE_SEARCH || options->engine == DOMINO_ENGINE_GRAPH ||
+                      options->engine == DOMINO_ENGINE_BEAM;
+  if(!valid_engine || options->threads < 1 || options->time_ms < 0 || options->beam_width < 1 ||
+     options->stats_interval < 0 || solver == NULL)
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  DominoSolver* s = (DominoSolver*)malloc(sizeof(DominoSolver));
+  if(s == NULL)
+    return DOMINO_ERR_NO_MEMORY;
+
+  options_init(&s->opt);
+  s->opt.engine = (options->engine == DOMINO_ENGINE_GRAPH) ? ENGINE_GRAPH :
+                  (options->engine == DOMINO_ENGINE_BEAM) ? ENGINE_BEAM : ENGINE_SEARCH;
+  s->opt.threads = options->threads;
+  s->opt.tt_mb = options->tt_mb;
+  s->opt.time_ms = options->time_ms;
+  s->opt.max_nodes = options->max_nodes;
+  s->opt.beam_width = options->beam_width;
+  s->opt.beam_exact = options->beam_exact;
+  s->opt.cache = options->cache;
+  s->opt.tb = options->tablebase;
+  s->opt.progress = options->progress;
+  s->opt.stats = options->stats;
+  s->opt.stats_interval = options->stats_interval;
+
+  if(!tt_create(&s->tt, s->opt.tt_mb)) {
+    free(s);
+    return DOMINO_ERR_NO_MEMORY;
+  }
+  s->field = arena_init(&s->arena, ARENA_BLOCK_SIZE) ? create_field_in(&s->arena) : NULL;
+  if(s->field == NULL) {
+    arena_free(&s->arena);
+    tt_free(&s->tt);
+    free(s);
+    return DOMINO_ERR_NO_MEMORY;
+  }
+  s->start = arena_mark(&s->arena);
+
+  uint32_t weights[TILE_KINDS];
+  for(int k=0; k<TILE_KINDS; k++)
+    weights[k] = 1;
+  sampler_init(&s->sampler, weights);
+  rng_seed(&s->rng, seed, stream);
+
+  *solver = s;
+  return DOMINO_OK;
+}
+
+void domino_solver_free(DominoSolver* solver) {
+  if(solver == NULL) return;
+
+  tt_free(&solver->tt);
+  arena_free(&solver->arena);
+  free(solver);
+}
+
+int domino_random_hand(DominoSolver* solver, DominoTile* tiles, int n) {
+  if(solver == NULL || n < 0 || (n > 0 && tiles == NULL))
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  for(int i=0; i<n; i++) {
+    Tile el = kind_tile(sample_kind(&solver->sampler, &solver->rng));
+    tiles[i].left = el.left;
+    tiles[i].right = el.right;
+  }
+
+  return DOMINO_OK;
+}
+
+int domino_seeded_hand(uint64_t seed, int mix, DominoTile* tiles, int n) {
+  if(mix < MIX_PLAIN || mix > MIX_SPECIAL || n < 0 || (n > 0 && tiles == NULL))
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  Tile* hand = (Tile*)malloc(sizeof(Tile) * (n > 0 ? n : 1));
+  if(hand == NULL)
+    return DOMINO_ERR_NO_MEMORY;
+
+  generate_seeded_hand(seed, mix, hand, n);
+  for(int i=0; i<n; i++) {
+    tiles[i].left = hand[i].left;
+    tiles[i].right = hand[i].right;
+  }
+
+  free(hand);
+  return DOMINO_OK;
+}
+
+int domino_solve(DominoSolver* solver, DominoTile const* tiles, int n, DominoResult* result) {
+  if(solver == NULL || result == NULL || n < 0 || (n > 0 && tiles == NULL))
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  //l'Arena del contesto torna al segno dopo il campo ad ogni ricerca
+  arena_rewind(&solver->arena, solver->start);
+  Hand hand;
+  if(!read_hand(&hand, tiles, n))
+    return DOMINO_ERR_INVALID_HAND;
+
+  //se il campo cresce il nuovo buffer deve sopravvivere alle ricerche successive, quindi il segno viene spostato dopo
+  Field* field = solver->field;
+  if(field->tiles->capacity < (size_t)hand.size + 1) {
+    if(!reserve_deque(field->tiles, hand.size + 1))
+      return DOMINO_ERR_NO_MEMORY;
+    solver->start = arena_mark(&solver->arena);
+  }
+
+  Result r;
+  bool hit;
+  if(!cached_solve(field, &hand, &solver->opt, &solver->tt, &r, &hit))
+    return DOMINO_ERR_NO_MEMORY;
+
+  result->moves = (DominoMove*)malloc(sizeof(DominoMove) * (r.line.size > 0 ? r.line.size : 1));
+  result->stats = NULL;
+#ifdef DOMINO_STATS
+  result->stats = (DominoStats*)malloc(sizeof(DominoStats));
+  if(result->stats != NULL) {
+    result->stats->stats = r.stats;
+    result->stats->nodes = r.nodes;
+    result->stats->cutoffs = r.cutoffs;
+  }
+#endif
+  if(result->moves == NULL) {
+    free(result->stats);
+    move_stack_free(&r.line);
+    return DOMINO_ERR_NO_MEMORY;
+  }
+
+  for(int i=0; i<r.line.size; i++) {
+    MoveRecord const* rec = &r.line.data[i];
+    Tile el = move_oriented(&rec->move);
+    DominoMove* m = &result->moves[i];
+
+    m->tile.left = el.left;
+    m->tile.right = el.right;
+    m->side = rec->move.pos;
+    m->placed.left = rec->left;
+    m->placed.right = rec->right;
+  }
+  result->n_moves = r.line.size;
+  result->total = r.total;
+  result->proven = r.proven;
+  result->nodes = r.nodes;
+  result->cutoffs = r.cutoffs;
+  result->optimum = r.optimum;
+  result->cache_hit = hit;
+
+  move_stack_free(&r.line);
+  return DOMINO_OK;
+}
+
+void domino_result_free(DominoResult* result) {
+  free(result->moves);
+  free(result->stats);
+  result->moves = NULL;
+  result->stats = NULL;
+  result->n_moves = 0;
+}
+
+int domino_result_print_stats(DominoResult const* result, FILE* out) {
+  if(result == NULL || result->stats == NULL || out == NULL)
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  STAT(print_stats(out, &result->stats->stats, result->stats->nodes, result->stats->cutoffs));
+  return DOMINO_OK;
+}
+
+int domino_cache_open(char const* path, size_t max_mb, DominoCache** cache) {
+  if(path == NULL || cache == NULL)
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  Cache* c = (Cache*)malloc(sizeof(Cache));
+  if(c == NULL)
+    return DOMINO_ERR_NO_MEMORY;
+
+  int status = cache_open(c, path, max_mb);
+  if(status != DOMINO_OK) {
+    cache_close(c);
+    free(c);
+    return status;
+  }
+
+  *cache = c;
+  return DOMINO_OK;
+}
+
+void domino_cache_close(DominoCache* cache) {
+  if(cache == NULL) return;
+
+  cache_close(cache);
+  free(cache);
+}
+
+int domino_tablebase_load(char const* path, DominoTablebase** tablebase) {
+  if(path == NULL || tablebase == NULL)
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  Tablebase* tb = (Tablebase*)malloc(sizeof(Tablebase));
+  if(tb == NULL)
+    return DOMINO_ERR_NO_MEMORY;
+
+  int status = tablebase_load(tb, path);
+  if(status != DOMINO_OK) {
+    free(tb);
+    return status;
+  }
+
+  *tablebase = tb;
+  return DOMINO_OK;
+}
+
+void domino_tablebase_free(DominoTablebase* tablebase) {
+  if(tablebase == NULL) return;
+
+  tablebase_free(tablebase);
+  free(tablebase);
+}
+
+int domino_tablebase_generate(char const* path, int tiles, int threads, FILE* log) {
+  if(path == NULL)
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  return tablebase_generate(path, tiles, threads, log);
+}
+
+int domino_game_create(DominoSolver const* solver, DominoTile const* tiles, int n, DominoGame** game) {
+  if(solver == NULL || game == NULL || n < 0 || (n > 0 && tiles == NULL))
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  DominoGame* g = (DominoGame*)malloc(sizeof(DominoGame));
+  if(g == NULL)
+    return DOMINO_ERR_NO_MEMORY;
+  if(!read_hand(&g->hand, tiles, n)) {
+    free(g);
+    return DOMINO_ERR_INVALID_HAND;
+  }
+
+  //il campo viene riservato per tutta la partita
+  g->field = create_field();
+  if(g->field == NULL || !reserve_deque(g->field->tiles, g->hand.size + 1)) {
+    free_field(g->field);
+    free(g);
+    return DOMINO_ERR_NO_MEMORY;
+  }
+  g->opt = solver->opt;
+  g->hints = NULL;
+
+  *game = g;
+  return DOMINO_OK;
+}
+
+void domino_game_free(DominoGame* game) {
+  if(game == NULL) return;
+
+  if(game->hints != NULL) {
+    hint_stop(game->hints);
+    free(game->hints);
+  }
+  free_field(game->field);
+  free(game);
+}
+
+int domino_game_play(DominoGame* game, char side, DominoTile tile) {
+  Tile el;
+  el.left = tile.left;
+  el.right = tile.right;
+
+  if(game == NULL || !move_tile(game->field, &game->hand, side, el))
+    return DOMINO_ERR_ILLEGAL_MOVE;
+
+  if(game->hints != NULL)
+    hint_update(game->hints, game->field, &game->hand);
+  return DOMINO_OK;
+}
+
+bool domino_game_can_move(DominoGame const* game) {
+  return possible_moves(game->field, &game->hand);
+}
+
+int domino_game_points(DominoGame const* game) {
+  return points(game->field);
+}
+
+int domino_game_field(DominoGame const* game, DominoTile* tiles, int max) {
+  int n = (int)game->field->tiles->size;
+
+  for(int i=0; i<n && i<max; i++) {
+    Tile el = field_at(game->field, i);
+    tiles[i].left = el.left;
+    tiles[i].right = el.right;
+  }
+
+  return n;
+}
+
+int domino_game_hand(DominoGame const* game, DominoTile* tiles, int max) {
+  int n = 0;
+
+  for(int k=0; k<TILE_KINDS; k++) {
+    Tile el = kind_tile(k);
+    for(int i=0; i<game->hand.count[k]; i++) {
+      if(n < max) {
+        tiles[n].left = el.left;
+        tiles[n].right = el.right;
+      }
+      n++;
+    }
+  }
+
+  return n;
+}
+
+int domino_game_start_hints(DominoGame* game) {
+  if(game == NULL || game->hints != NULL)
+    return DOMINO_ERR_INVALID_ARGUMENT;
+
+  game->hints = (HintEngine*)malloc(sizeof(HintEngine));
+  if(game->hints == NULL)
+    return DOMINO_ERR_NO_MEMORY;
+
+  if(!hint_start(game->hints, game->field, &game->hand, &game->opt)) {
+    free(game->hints);
+    game->hints = NULL;
+    return DOMINO_ERR_NO_MEMORY;
+  }
+  return DOMINO_OK;
+}
+
+bool domino_game_hint(DominoGame* game, char* side, DominoTile* tile, int* total, bool* proven) {
+  Move m;
+  if(game == NULL || game->hints == NULL || !hint_get(game->hints, &m, total, proven))
+    return false;
+
+  Tile el = move_oriented(&m);
+  *side = m.pos;
+  tile->left = el.left;
+  tile->right = el.right;
+  return true;
+}
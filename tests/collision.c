@@ -0,0 +1,57 @@
+/**
+ * @file collision.c
+ * @author FafNir
+ * @brief Test di regressione per la chiave della mano nella tabella delle trasposizioni: la chiave è la somma di
+ * kind_key sulle tessere della mano e con kind_key(k) = mix64(k+1) valeva 2*mix64(15) == mix64(30), quindi due [3|3]
+ * avevano la stessa chiave di una [5|6]. Il test controlla che tutte le mani di una o due tessere abbiano chiavi diverse
+ */
+
+//kind_key è interna alla libreria, quindi il motore viene incluso per intero
+#include "../solver.c"
+
+/// @brief Numero massimo di chiavi confrontate: una o due tessere per mano
+#define MAX_KEYS (TILE_KINDS + TILE_KINDS*(TILE_KINDS+1)/2)
+
+/**
+ * @brief Funzione di confronto tra chiavi per qsort
+ * @param a prima chiave
+ * @param b seconda chiave
+ * @return Un valore negativo, nullo o positivo come richiesto da qsort
+*/
+int compare_keys(void const* a, void const* b) {
+  uint64_t x = *(uint64_t const*)a;
+  uint64_t y = *(uint64_t const*)b;
+  return (x > y) - (x < y);
+}
+
+int main(void) {
+  //tipi di tessera distinti, una sola orientazione per le tessere normali
+  int kinds[TILE_KINDS];
+  int n_kinds = 0;
+  for(int k=0; k<TILE_KINDS; k++) {
+    Tile el = kind_tile(k);
+    if(el.left <= el.right)
+      kinds[n_kinds++] = k;
+  }
+
+  uint64_t keys[MAX_KEYS];
+  size_t n_keys = 0;
+  for(int i=0; i<n_kinds; i++) {
+    keys[n_keys++] = kind_key(kinds[i]);
+    for(int j=i; j<n_kinds; j++)
+      keys[n_keys++] = kind_key(kinds[i]) + kind_key(kinds[j]);
+  }
+
+  qsort(keys, n_keys, sizeof(uint64_t), compare_keys);
+
+  int failures = 0;
+  for(size_t i=1; i<n_keys; i++) {
+    if(keys[i] == keys[i-1]) {
+      fprintf(stderr, "collision: two hands share the key %016llx\n", (unsigned long long)keys[i]);
+      failures++;
+    }
+  }
+
+  printf("collision: %zu hands, %d collisions\n", n_keys, failures);
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file engines.c
+ * @author FafNir
+ * @brief Test che confronta il motore a grafo con la ricerca sull'albero delle mosse su mani casuali: entrambi sono
+ * esatti, quindi devono trovare lo stesso punteggio
+ */
+
+#include<stdio.h>
+#include<stdlib.h>
+#include "../domino.h"
+
+/// @brief Numero di mani per ogni dimensione
+#define HANDS_PER_SIZE 15
+/// @brief Dimensione minima delle mani
+#define MIN_SIZE 4
+/// @brief Dimensione massima delle mani con tessere speciali
+#define MAX_MIXED_SIZE 14
+/// @brief Dimensione massima delle mani senza tessere speciali, risolte quasi solo dal motore a grafo
+#define MAX_PLAIN_SIZE 20
+
+/**
+ * @brief Funzione che estrae una mano casuale, scartando le tessere speciali se plain è true
+ * @param solver contesto da cui estrarre le tessere
+ * @param tiles array di almeno n elementi
+ * @param n numero di tessere
+ * @param plain true per una mano senza tessere speciali
+*/
+void random_hand(DominoSolver* solver, DominoTile* tiles, int n, bool plain) {
+  int size = 0;
+
+  while(size < n) {
+    domino_random_hand(solver, &tiles[size], 1);
+    if(!plain || tiles[size].left <= 6)
+      size++;
+  }
+}
+
+int main(void) {
+  DominoOptions opt;
+  domino_options_default(&opt);
+  opt.tt_mb = 16;
+
+  DominoSolver* search;
+  DominoSolver* graph;
+  opt.engine = DOMINO_ENGINE_SEARCH;
+  int status = domino_solver_create(&opt, 2016, 0, &search);
+  opt.engine = DOMINO_ENGINE_GRAPH;
+  if(status == DOMINO_OK)
+    status = domino_solver_create(&opt, 2016, 0, &graph);
+  if(status != DOMINO_OK) {
+    fprintf(stderr, "engines: cannot create the solvers\n");
+    return EXIT_FAILURE;
+  }
+
+  int hands = 0;
+  int failures = 0;
+  DominoTile tiles[MAX_PLAIN_SIZE];
+
+  for(int plain=0; plain<=1; plain++) {
+    int max_size = plain ? MAX_PLAIN_SIZE : MAX_MIXED_SIZE;
+
+    for(int size=MIN_SIZE; size<=max_size; size++) {
+      for(int i=0; i<HANDS_PER_SIZE; i++) {
+        DominoResult a, b;
+        random_hand(search, tiles, size, plain);
+        if(domino_solve(search, tiles, size, &a) != DOMINO_OK || domino_solve(graph, tiles, size, &b) != DOMINO_OK) {
+          fprintf(stderr, "engines: solve failed\n");
+          return EXIT_FAILURE;
+        }
+
+        if(a.total != b.total) {
+          fprintf(stderr, "engines: search %d graph %d on", a.total, b.total);
+          for(int t=0; t<size; t++)
+            fprintf(stderr, " %d %d", tiles[t].left, tiles[t].right);
+          fprintf(stderr, "\n");
+          failures++;
+        }
+        hands++;
+
+        domino_result_free(&a);
+        domino_result_free(&b);
+      }
+    }
+  }
+
+  domino_solver_free(search);
+  domino_solver_free(graph);
+
+  printf("engines: %d hands, %d mismatches\n", hands, failures);
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
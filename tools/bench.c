@@ -0,0 +1,357 @@
+/**
+ * @file bench.c
+ * @author FafNir
+ * @brief Benchmark della libreria libdomino: risolve un corpus fisso di mani generate dal seme e ne scrive i risultati,
+ * oppure confronta due file di risultati e segnala le regressioni. Ogni caso viene eseguito in un processo a parte,
+ * così il picco di memoria riportato è quello del solo caso e non dei casi eseguiti prima
+ *
+ * @section uso Uso
+ *  - "make bench" compila il benchmark e lo esegue con le opzioni predefinite
+ *  - "./tools/bench [opzioni] > nuovo.txt" scrive i risultati, "./tools/bench --compare vecchio.txt nuovo.txt" li confronta
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<stdbool.h>
+#include<stdint.h>
+#include<unistd.h>
+#include<sys/resource.h>
+#include<sys/wait.h>
+#include "../domino.h"
+
+/// @brief Numero di esecuzioni di ogni caso del benchmark, di cui si tiene il tempo minimo
+#define BENCH_REPS 3
+/// @brief Numero massimo di posizioni espanse per ogni caso del benchmark, se non indicato con --nodes
+#define BENCH_DEFAULT_NODES 500000
+/// @brief Percentuale di aumento del tempo oltre la quale un caso del benchmark è segnalato come regressione
+#define BENCH_DEFAULT_THRESHOLD 10.0
+/// @brief Differenza di tempo in millisecondi sotto la quale il confronto del benchmark la considera rumore
+#define BENCH_NOISE_MS 1.0
+/// @brief Numero massimo di tessere di un caso del benchmark
+#define BENCH_MAX_TILES 100
+
+/**
+ * @struct BenchOptions
+ * @brief Definisce il tipo BenchOptions: le opzioni passate da riga di comando
+*/
+typedef struct {
+  /** Opzioni dei contesti del risolutore usati per ogni caso */
+  DominoOptions solver;
+  /** File della tablebase da consultare (NULL se non attiva) */
+  char const* tablebase;
+  /** File dei risultati del benchmark da confrontare: vecchi e nuovi (NULL se il confronto non è richiesto) */
+  char const* compare[2];
+  /** Percentuale di aumento del tempo oltre la quale il confronto segnala una regressione */
+  double threshold;
+} BenchOptions;
+
+/**
+ * @struct BenchCase
+ * @brief Definisce il tipo BenchCase: una mano del benchmark, generata in modo riproducibile dal seme
+*/
+typedef struct {
+  /** Nome del caso, usato per confrontare i risultati */
+  char name[32];
+  /** Numero di tessere */
+  int size;
+  /** Composizione della mano (DOMINO_MIX_PLAIN, DOMINO_MIX_UNIFORM o DOMINO_MIX_SPECIAL) */
+  int mix;
+  /** Seme della mano */
+  uint64_t seed;
+} BenchCase;
+
+/**
+ * @struct BenchResult
+ * @brief Definisce il tipo BenchResult: una riga di un file di risultati del benchmark
+*/
+typedef struct {
+  /** Nome del caso */
+  char name[32];
+  /** Punteggio trovato */
+  int score;
+  /** 1 se il punteggio è dimostrato ottimo, 0 altrimenti */
+  int proven;
+  /** Posizioni espanse */
+  unsigned long long nodes;
+  /** Tempo minimo in millisecondi */
+  double ms;
+} BenchResult;
+
+/**
+ * @brief Funzione che restituisce il tempo di un orologio monotono
+ * @return Il tempo in microsecondi
+*/
+long long clock_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+}
+
+/**
+ * @brief Funzione che restituisce il picco di memoria residente del processo
+ * @return Il picco di memoria in KB
+*/
+long peak_rss_kb(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_maxrss;
+}
+
+/**
+ * @brief Funzione che risolve un caso del benchmark BENCH_REPS volte, ognuna con un contesto nuovo, e ne scrive
+ * la riga dei risultati su stdout. Va eseguita nel processo del caso, perché il picco di memoria è quello del processo
+ * @param c caso da risolvere
+ * @param options opzioni dei contesti
+*/
+void bench_case(BenchCase const* c, DominoOptions const* options) {
+  DominoTile tiles[BENCH_MAX_TILES];
+  domino_seeded_hand(c->seed, c->mix, tiles, c->size);
+
+  //ogni esecuzione parte da un contesto nuovo, con una tabella vuota, così i casi non dipendono dall'ordine
+  DominoResult r;
+  double best_ms = -1;
+  for(int rep=0; rep<BENCH_REPS; rep++) {
+    DominoSolver* solver;
+    int status = domino_solver_create(options, 0, 0, &solver);
+    if(status != DOMINO_OK) {
+      printf("[+]Error: %s. Exiting program", domino_strerror(status));
+      exit(EXIT_FAILURE);
+    }
+
+    long long start = clock_us();
+    status = domino_solve(solver, tiles, c->size, &r);
+    double ms = (clock_us() - start) / 1000.0;
+    domino_solver_free(solver);
+    if(status != DOMINO_OK) {
+      printf("[+]Error: %s. Exiting program", domino_strerror(status));
+      exit(EXIT_FAILURE);
+    }
+
+    if(best_ms < 0 || ms < best_ms)
+      best_ms = ms;
+    if(rep+1 < BENCH_REPS)
+      domino_result_free(&r);
+  }
+
+  double nps = best_ms > 0 ? r.nodes / (best_ms / 1000.0) : 0;
+  printf("%s\t%d\t%d\t%d\t%llu\t%.3f\t%.0f\t%ld\n", c->name, c->size, r.total, r.proven ? 1 : 0,
+         (unsigned long long)r.nodes, best_ms, nps, peak_rss_kb());
+  fflush(stdout);
+
+  domino_result_free(&r);
+}
+
+/**
+ * @brief Funzione che scrive su stdout i risultati del benchmark: per ogni caso del corpus fisso nome, tessere,
+ * punteggio, 1 se dimostrato ottimo, posizioni espanse, tempo minimo su BENCH_REPS esecuzioni in millisecondi,
+ * posizioni al secondo e picco di memoria in KB del processo del caso, separati da tabulazioni.
+ * Se opt non fissa un budget ogni caso è limitato a BENCH_DEFAULT_NODES posizioni, così il risultato non dipende dalla macchina
+ * @param opt opzioni
+*/
+void bench_mode(BenchOptions const* opt) {
+  int sizes[] = {8, 12, 16, 20, 30, 50, 100};
+  char const* mixes[] = {"plain", "uniform", "special"};
+  int n_sizes = sizeof(sizes)/sizeof(sizes[0]);
+
+  //la tablebase viene mappata una volta sola, prima di creare i processi dei casi che la condividono
+  DominoTablebase* tb = NULL;
+  if(opt->tablebase != NULL && domino_tablebase_load(opt->tablebase, &tb) != DOMINO_OK) {
+    printf("[+]Error: Cannot load the tablebase %s. Exiting program", opt->tablebase);
+    exit(EXIT_FAILURE);
+  }
+
+  DominoOptions bench_opt = opt->solver;
+  bench_opt.tablebase = tb;
+  if(bench_opt.time_ms == 0 && bench_opt.max_nodes == 0)
+    bench_opt.max_nodes = BENCH_DEFAULT_NODES;
+
+  printf("#case\ttiles\tscore\tproven\tnodes\tms\tnodes_per_sec\tpeak_rss_kb\n");
+  fflush(stdout);
+
+  for(int i=0; i<n_sizes; i++) {
+    for(int mix=DOMINO_MIX_PLAIN; mix<=DOMINO_MIX_SPECIAL; mix++) {
+      BenchCase c;
+      snprintf(c.name, sizeof(c.name), "%s-%d", mixes[mix], sizes[i]);
+      c.size = sizes[i];
+      c.mix = mix;
+      c.seed = domino_seed_mix((uint64_t)c.size*4 + mix);
+
+      pid_t pid = fork();
+      if(pid < 0) {
+        printf("[+]Error: Cannot start the process of %s. Exiting program", c.name);
+        exit(EXIT_FAILURE);
+      }
+      if(pid == 0) {
+        bench_case(&c, &bench_opt);
+        exit(EXIT_SUCCESS);
+      }
+
+      int status;
+      if(waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        exit(EXIT_FAILURE);
+    }
+  }
+
+  domino_tablebase_free(tb);
+}
+
+/**
+ * @brief Funzione che legge un file di risultati del benchmark
+ * @param path percorso del file
+ * @param count puntatore in cui viene scritto il numero di risultati
+ * @return array di risultati allocato, da liberare con free
+*/
+BenchResult* read_bench(char const* path, int* count) {
+  FILE* in = fopen(path, "r");
+  if(in == NULL) {
+    printf("[+]Error: Cannot open %s. Exiting program", path);
+    exit(EXIT_FAILURE);
+  }
+
+  int capacity = 32;
+  BenchResult* results = (BenchResult*)malloc(sizeof(BenchResult) * capacity);
+  if(results == NULL) {
+    printf("[+]Error: Memory allocation failed. Exiting program");
+    exit(EXIT_FAILURE);
+  }
+
+  char line[256];
+  *count = 0;
+  while(fgets(line, sizeof(line), in) != NULL) {
+    if(line[0] == '#') continue;
+
+    if(*count == capacity) {
+      capacity *= 2;
+      BenchResult* new_results = (BenchResult*)realloc(results, sizeof(BenchResult) * capacity);
+      if(new_results == NULL) {
+        printf("[+]Error: Memory allocation failed. Exiting program");
+        exit(EXIT_FAILURE);
+      }
+      results = new_results;
+    }
+
+    BenchResult* b = &results[*count];
+    int tiles;
+    if(sscanf(line, "%31s %d %d %d %llu %lf", b->name, &tiles, &b->score, &b->proven, &b->nodes, &b->ms) == 6)
+      (*count)++;
+  }
+
+  fclose(in);
+  return results;
+}
+
+/**
+ * @brief Funzione che confronta due file di risultati del benchmark e stampa i casi in cui il tempo è aumentato
+ * oltre opt->threshold per cento (e di almeno BENCH_NOISE_MS) o in cui il punteggio è cambiato
+ * @param opt opzioni, con i file da confrontare in opt->compare
+ * @return Il numero di regressioni
+*/
+int bench_compare(BenchOptions const* opt) {
+  int n_old, n_new;
+  BenchResult* old = read_bench(opt->compare[0], &n_old);
+  BenchResult* new = read_bench(opt->compare[1], &n_new);
+  int regressions = 0;
+
+  printf("#case\told_ms\tnew_ms\tchange_pct\tstatus\n");
+  for(int i=0; i<n_new; i++) {
+    BenchResult const* b = &new[i];
+    BenchResult const* a = NULL;
+    for(int j=0; j<n_old && a == NULL; j++)
+      if(strcmp(old[j].name, b->name) == 0)
+        a = &old[j];
+
+    if(a == NULL) {
+      printf("%s\t-\t%.3f\t-\tnew\n", b->name, b->ms);
+      continue;
+    }
+
+    double change = a->ms > 0 ? (b->ms - a->ms) / a->ms * 100 : 0;
+    char const* status = "ok";
+    //con lo stesso budget un punteggio diverso indica un cambiamento nel risultato, non solo nei tempi
+    if(a->score != b->score || a->proven != b->proven) {
+      status = "SCORE CHANGED";
+      regressions++;
+    } else if(change > opt->threshold && b->ms - a->ms > BENCH_NOISE_MS) {
+      status = "REGRESSION";
+      regressions++;
+    } else if(change < -opt->threshold && a->ms - b->ms > BENCH_NOISE_MS) {
+      status = "improved";
+    }
+
+    printf("%s\t%.3f\t%.3f\t%+.1f\t%s\n", b->name, a->ms, b->ms, change, status);
+  }
+
+  printf("Regressions: %d\n", regressions);
+  free(old);
+  free(new);
+  return regressions;
+}
+
+/**
+ * @brief Funzione che legge le opzioni da riga di comando
+ * @param argc Numero di argomenti
+ * @param argv Argomenti passati al programma
+ * @param opt BenchOptions in cui vengono scritte le opzioni lette
+*/
+void parse_options(int argc, char** argv, BenchOptions* opt) {
+  domino_options_default(&opt->solver);
+  opt->tablebase = NULL;
+  opt->compare[0] = NULL;
+  opt->compare[1] = NULL;
+  opt->threshold = BENCH_DEFAULT_THRESHOLD;
+
+  for(int i=1; i<argc; i++) {
+    if(strcmp(argv[i], "--tt-mb") == 0 && i+1 < argc) {
+      opt->solver.tt_mb = strtoul(argv[++i], NULL, 10);
+    } else if(strcmp(argv[i], "--threads") == 0 && i+1 < argc) {
+      opt->solver.threads = atoi(argv[++i]);
+      if(opt->solver.threads < 1)
+        opt->solver.threads = 1;
+    } else if(strcmp(argv[i], "--time-ms") == 0 && i+1 < argc) {
+      opt->solver.time_ms = strtol(argv[++i], NULL, 10);
+    } else if(strcmp(argv[i], "--nodes") == 0 && i+1 < argc) {
+      opt->solver.max_nodes = strtoull(argv[++i], NULL, 10);
+    } else if(strcmp(argv[i], "--engine") == 0 && i+1 < argc && strcmp(argv[i+1], "search") == 0) {
+      opt->solver.engine = DOMINO_ENGINE_SEARCH;
+      i++;
+    } else if(strcmp(argv[i], "--engine") == 0 && i+1 < argc && strcmp(argv[i+1], "graph") == 0) {
+      opt->solver.engine = DOMINO_ENGINE_GRAPH;
+      i++;
+    } else if(strcmp(argv[i], "--engine") == 0 && i+1 < argc && strcmp(argv[i+1], "beam") == 0) {
+      opt->solver.engine = DOMINO_ENGINE_BEAM;
+      i++;
+    } else if(strcmp(argv[i], "--beam-width") == 0 && i+1 < argc) {
+      opt->solver.beam_width = atoi(argv[++i]);
+      if(opt->solver.beam_width < 1)
+        opt->solver.beam_width = 1;
+    } else if(strcmp(argv[i], "--tablebase") == 0 && i+1 < argc) {
+      opt->tablebase = argv[++i];
+    } else if(strcmp(argv[i], "--compare") == 0 && i+2 < argc) {
+      opt->compare[0] = argv[++i];
+      opt->compare[1] = argv[++i];
+    } else if(strcmp(argv[i], "--threshold") == 0 && i+1 < argc) {
+      opt->threshold = strtod(argv[++i], NULL);
+    } else {
+      printf("Usage: %s [--tt-mb MB] [--threads N] [--time-ms MS] [--nodes N] [--engine search|graph|beam] "
+             "[--beam-width W] [--tablebase FILE] [--compare OLD NEW] [--threshold PCT]\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  BenchOptions opt;
+  parse_options(argc, argv, &opt);
+
+  if(opt.compare[0] != NULL)
+    return bench_compare(&opt) > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+
+  bench_mode(&opt);
+  return EXIT_SUCCESS;
+}